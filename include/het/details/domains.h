@@ -10,6 +10,11 @@
 
 #include <type_traits>
 #include <concepts>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
 
 namespace het {
 
@@ -23,11 +28,97 @@ template <typename T> concept projection_clause = requires(T t) {
   requires std::equality_comparable<std::decay_t<decltype(t.second)>>;
 };
 
+/**
+ * \brief Bounds of the projected value, the clause having bounds as its second matches the values within them
+ * \tparam V type of the bounds, compared to the projected values by operator<
+ * \details missing bound is unlimited, see lt(), le(), gt(), ge() and between()
+ */
+template <typename V> struct bounds {
+  std::optional<V> lo;
+  std::optional<V> hi;
+  bool lo_open = false;
+  bool hi_open = false;
+
+  template <typename U> [[nodiscard]] constexpr bool contains(U const & value) const {
+    return (!lo || (lo_open ? *lo < value : !(value < *lo))) && (!hi || (hi_open ? value < *hi : !(*hi < value)));
+  }
+
+  friend constexpr bool operator==(bounds const &, bounds const &) = default;
+};
+
+template <typename T> inline constexpr bool is_bounds = false;
+template <typename V> inline constexpr bool is_bounds<bounds<V>> = true;
+
+// type of the value the clause compares projections with
+template <typename T> struct clause_value { using type = T; };
+template <typename V> struct clause_value<bounds<V>> { using type = V; };
+template <typename T> using clause_value_t = typename clause_value<std::remove_cvref_t<T>>::type;
+
+/// \brief Range clause matching the elements whose projection is less than the value
+template <typename P, typename V> constexpr auto lt(P projection, V value) {
+  return std::pair{projection, bounds<V>{std::nullopt, std::move(value), false, true}};
+}
+
+/// \brief Range clause matching the elements whose projection is less than or equal to the value
+template <typename P, typename V> constexpr auto le(P projection, V value) {
+  return std::pair{projection, bounds<V>{std::nullopt, std::move(value), false, false}};
+}
+
+/// \brief Range clause matching the elements whose projection is greater than the value
+template <typename P, typename V> constexpr auto gt(P projection, V value) {
+  return std::pair{projection, bounds<V>{std::move(value), std::nullopt, true, false}};
+}
+
+/// \brief Range clause matching the elements whose projection is greater than or equal to the value
+template <typename P, typename V> constexpr auto ge(P projection, V value) {
+  return std::pair{projection, bounds<V>{std::move(value), std::nullopt, false, false}};
+}
+
+/// \brief Range clause matching the elements whose projection lies within [lo, hi]
+template <typename P, typename V> constexpr auto between(P projection, V lo, V hi) {
+  return std::pair{projection, bounds<V>{std::move(lo), std::move(hi), false, false}};
+}
+
+/// \brief Checks the element against the equality or the range clause
+template <projection_clause Clause, typename Obj> constexpr bool clause_matches(Clause const & clause, Obj const & obj) {
+  if constexpr(is_bounds<std::remove_cvref_t<decltype(clause.second)>>) {
+    return clause.second.contains(std::invoke(clause.first, obj));
+  } else {
+    return std::invoke(clause.first, obj) == clause.second;
+  }
+}
+
+/// \brief Argument of the variadic element constructor, i.e. neither the object itself nor the
+/// memory resource or allocator tag picked by the allocator-aware constructors
+template <typename T, typename Self> concept is_element_argument =
+    !std::same_as<std::remove_cvref_t<T>, Self> &&
+    !std::same_as<std::remove_cvref_t<T>, std::allocator_arg_t> &&
+    !std::convertible_to<T, std::pmr::memory_resource *>;
+
 template <template <typename, typename, typename...> class C>
 concept is_assoc_container = requires {
   typename C<int, int>::key_type;
 };
 
+/// \brief Storage tag, keeps fractions in a per-instance table indexed by the dense type id
+/// instead of the process-wide registry keyed by the container address.
+template <typename K, typename V, typename...> struct indexed_storage {};
+
+template <template <typename, typename, typename...> class C>
+concept is_indexed_storage = std::same_as<C<int, int>, indexed_storage<int, int>>;
+
+/// \brief Map of a single owner nested into the registry entry, a registry may replace it by
+/// the lighter `owner_map_type` since the entry is never shared between owners
+template <template <typename, typename, typename...> class C, typename K, typename V>
+struct owner_map { using type = C<K, V>; };
+
+template <template <typename, typename, typename...> class C, typename K, typename V>
+requires requires { typename C<K, V>::owner_map_type; }
+struct owner_map<C, K, V> { using type = typename C<K, V>::owner_map_type; };
+
+template <template <typename, typename, typename...> class C, typename K, typename V>
+using owner_map_t = typename owner_map<C, K, V>::type;
+
 template <typename K, typename V, template <typename, typename, typename...> class C>
 concept is_suitable_container = requires(C<K, V> c) {
   typename C<K, V>::key_type;
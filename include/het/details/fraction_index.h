@@ -0,0 +1,319 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_FRACTION_INDEX_H
+#define HETLIB_FRACTION_INDEX_H
+
+#include "domains.h"
+#include "memory_usage.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace het::details {
+
+class fraction_index;
+
+struct index_deleter {
+  void operator()(fraction_index * idx) const noexcept;
+};
+
+/// \brief Owning pointer to the index allocated from the memory resource, see make_index()
+using index_ptr = std::unique_ptr<fraction_index, index_deleter>;
+
+/**
+ * \brief Secondary index over the fraction of a single type
+ * \details Entries refer to elements by their offsets in the fraction, the owner reports every
+ * structural change of the fraction so the offsets follow the elements.
+ */
+class fraction_index {
+public:
+  explicit fraction_index(std::size_t type) noexcept : _type(type) {}
+  virtual ~fraction_index() = default;
+
+  // dense type id of the indexed fraction
+  [[nodiscard]] std::size_t type() const noexcept { return _type; }
+  // identity of the index kind along with the fraction and projection types
+  [[nodiscard]] virtual void const * tag() const noexcept = 0;
+  // copy of the index allocated from the resource along with its entries
+  [[nodiscard]] virtual index_ptr clone(std::pmr::memory_resource * resource) const = 0;
+  [[nodiscard]] virtual std::size_t bytes() const noexcept = 0;
+  // destroys the index releasing it to the memory resource it's allocated from
+  virtual void destroy() noexcept = 0;
+
+  // the element at the offset is inserted, the following elements are shifted forth
+  virtual void inserted(void const * fraction, std::size_t offset) = 0;
+  // the elements from the offset to the end of the fraction are appended
+  virtual void appended(void const * fraction, std::size_t from) = 0;
+  // the element at the offset is about to be erased, the following elements are shifted back
+  virtual void erasing(void const * fraction, std::size_t offset) = 0;
+  // the element at the offset is about to be changed in place, its entry is dropped
+  virtual void updating(void const * fraction, std::size_t offset) = 0;
+  // the element at the offset is changed in place, its entry is added back by the new projection
+  virtual void updated(void const * fraction, std::size_t offset) = 0;
+  virtual void rebuild(void const * fraction) = 0;
+  virtual void clear() noexcept = 0;
+
+private:
+  std::size_t _type;
+};
+
+inline void index_deleter::operator()(fraction_index * idx) const noexcept {
+  idx->destroy();
+}
+
+/// \brief Allocates the index from the memory resource, which allocates its entries as well
+template <typename Index, typename... Args> [[nodiscard]] index_ptr make_index(std::pmr::memory_resource * resource, Args &&... args) {
+  return index_ptr(std::pmr::polymorphic_allocator<>(resource).template new_object<Index>(std::forward<Args>(args)..., resource));
+}
+
+/**
+ * \brief Hash index of the fraction elements by the value of their projection
+ * \tparam T type of the elements
+ * \tparam C type of the fraction
+ * \tparam P projection, pointer to the data member or to the getter
+ * \note inserting into the middle or erasing but the last element shifts the offsets, it's O(size)
+ */
+template <typename T, typename C, typename P> class hash_index final : public fraction_index {
+  static constexpr char _tag = 0;
+
+public:
+  using key_type = std::remove_cvref_t<std::invoke_result_t<P const &, T const &>>;
+  using map_type = std::pmr::unordered_multimap<key_type, std::size_t>;
+
+  hash_index(std::size_t type, P projection, std::pmr::memory_resource * resource)
+    : fraction_index(type), _projection(projection), _offsets(resource) {}
+
+  hash_index(hash_index const & other, std::pmr::memory_resource * resource)
+    : fraction_index(other), _projection(other._projection), _offsets(other._offsets, resource) {}
+
+  [[nodiscard]] static void const * kind() noexcept { return &_tag; }
+  [[nodiscard]] void const * tag() const noexcept override { return kind(); }
+  [[nodiscard]] P const & projection() const noexcept { return _projection; }
+
+  [[nodiscard]] index_ptr clone(std::pmr::memory_resource * resource) const override {
+    return make_index<hash_index>(resource, *this);
+  }
+
+  void destroy() noexcept override {
+    std::pmr::polymorphic_allocator<>(_offsets.get_allocator().resource()).delete_object(this);
+  }
+
+  [[nodiscard]] std::size_t bytes() const noexcept override {
+    return sizeof(hash_index) + _offsets.size() * node_bytes<map_type> + _offsets.bucket_count() * sizeof(void *);
+  }
+
+  /// \brief Offsets of the elements having the key, in no particular order
+  [[nodiscard]] auto equal_range(key_type const & key) const {
+    return _offsets.equal_range(key);
+  }
+
+  // the entry is added before the offsets are shifted, so the index is left intact if it throws
+  void inserted(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    auto added = _offsets.emplace(std::invoke(_projection, *std::next(std::begin(c), offset)), offset);
+    if(offset + 1 != std::size(c)) {
+      for(auto it = std::begin(_offsets); it != std::end(_offsets); ++it) {
+        it->second += it != added && it->second >= offset ? 1 : 0;
+      }
+    }
+  }
+
+  void appended(void const * fraction, std::size_t from) override {
+    auto & c = *static_cast<C const *>(fraction);
+    _offsets.reserve(std::size(c));
+    for(auto it = std::next(std::begin(c), from); it != std::end(c); ++it) {
+      _offsets.emplace(std::invoke(_projection, *it), from++);
+    }
+  }
+
+  void erasing(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    updating(fraction, offset);
+    if(offset + 1 != std::size(c)) {
+      for(auto & e : _offsets) {
+        e.second -= e.second > offset ? 1 : 0;
+      }
+    }
+  }
+
+  void updating(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    auto [first, last] = _offsets.equal_range(std::invoke(_projection, *std::next(std::begin(c), offset)));
+    for(; first != last; ++first) {
+      if(first->second == offset) {
+        _offsets.erase(first);
+        break;
+      }
+    }
+  }
+
+  void updated(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    _offsets.emplace(std::invoke(_projection, *std::next(std::begin(c), offset)), offset);
+  }
+
+  void rebuild(void const * fraction) override {
+    _offsets.clear();
+    appended(fraction, 0);
+  }
+
+  void clear() noexcept override {
+    _offsets.clear();
+  }
+
+private:
+  P _projection;
+  map_type _offsets;
+};
+
+/**
+ * \brief Ordered index of the fraction elements by the value of their projection, backed by the sorted array
+ * \tparam T type of the elements
+ * \tparam C type of the fraction
+ * \tparam P projection, pointer to the data member or to the getter
+ * \note entries of equal keys go in the fraction order; appending elements of ascending keys (timestamps)
+ *       costs O(log size), other insertions and erasures are O(size)
+ */
+template <typename T, typename C, typename P> class ordered_index final : public fraction_index {
+  static constexpr char _tag = 0;
+
+public:
+  using key_type = std::remove_cvref_t<std::invoke_result_t<P const &, T const &>>;
+
+  struct entry {
+    key_type key;
+    std::size_t offset;
+  };
+
+  using entries_type = std::pmr::vector<entry>;
+  using const_iterator = typename entries_type::const_iterator;
+
+  ordered_index(std::size_t type, P projection, std::pmr::memory_resource * resource) noexcept
+    : fraction_index(type), _projection(projection), _entries(resource) {}
+
+  ordered_index(ordered_index const & other, std::pmr::memory_resource * resource)
+    : fraction_index(other), _projection(other._projection), _entries(other._entries, resource) {}
+
+  [[nodiscard]] static void const * kind() noexcept { return &_tag; }
+  [[nodiscard]] void const * tag() const noexcept override { return kind(); }
+  [[nodiscard]] P const & projection() const noexcept { return _projection; }
+
+  [[nodiscard]] index_ptr clone(std::pmr::memory_resource * resource) const override {
+    return make_index<ordered_index>(resource, *this);
+  }
+
+  void destroy() noexcept override {
+    std::pmr::polymorphic_allocator<>(_entries.get_allocator().resource()).delete_object(this);
+  }
+
+  [[nodiscard]] std::size_t bytes() const noexcept override {
+    return sizeof(ordered_index) + _entries.capacity() * sizeof(entry);
+  }
+
+  /// \brief Entries of the keys within the bounds, in the order of the keys
+  template <typename V> [[nodiscard]] auto range(bounds<V> const & b) const -> std::ranges::subrange<const_iterator> {
+    auto first = std::cbegin(_entries), last = std::cend(_entries);
+    if(b.lo) {
+      first = b.lo_open ? upper_bound(*b.lo) : lower_bound(*b.lo);
+    }
+    if(b.hi) {
+      last = b.hi_open ? lower_bound(*b.hi) : upper_bound(*b.hi);
+    }
+    return {first, std::max(first, last)};
+  }
+
+  // the entry is added before the offsets are shifted, so the index is left intact if it throws;
+  // it goes ahead of the shifted entries of the equal key as the shift keeps their order
+  void inserted(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    entry e{std::invoke(_projection, *std::next(std::begin(c), offset)), offset};
+    auto added = _entries.insert(position(e), std::move(e));
+    if(offset + 1 != std::size(c)) {
+      for(auto it = std::begin(_entries); it != std::end(_entries); ++it) {
+        it->offset += it != added && it->offset >= offset ? 1 : 0;
+      }
+    }
+  }
+
+  void appended(void const * fraction, std::size_t from) override {
+    auto & c = *static_cast<C const *>(fraction);
+    auto size = _entries.size();
+    _entries.reserve(size + std::size(c) - from);
+    for(auto it = std::next(std::begin(c), from); it != std::end(c); ++it) {
+      _entries.push_back({std::invoke(_projection, *it), from++});
+    }
+    auto mid = std::next(std::begin(_entries), static_cast<std::ptrdiff_t>(size));
+    if(!std::is_sorted(mid, std::end(_entries), less)) {
+      std::sort(mid, std::end(_entries), less);
+    }
+    std::inplace_merge(std::begin(_entries), mid, std::end(_entries), less);
+  }
+
+  void erasing(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    updating(fraction, offset);
+    if(offset + 1 != std::size(c)) {
+      for(auto & x : _entries) {
+        x.offset -= x.offset > offset ? 1 : 0;
+      }
+    }
+  }
+
+  void updating(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    entry e{std::invoke(_projection, *std::next(std::begin(c), offset)), offset};
+    if(auto it = position(e); it != std::end(_entries) && it->offset == offset) {
+      _entries.erase(it);
+    }
+  }
+
+  void updated(void const * fraction, std::size_t offset) override {
+    auto & c = *static_cast<C const *>(fraction);
+    entry e{std::invoke(_projection, *std::next(std::begin(c), offset)), offset};
+    _entries.insert(position(e), std::move(e));
+  }
+
+  void rebuild(void const * fraction) override {
+    _entries.clear();
+    appended(fraction, 0);
+  }
+
+  void clear() noexcept override {
+    _entries.clear();
+  }
+
+private:
+  static bool less(entry const & lhs, entry const & rhs) {
+    return lhs.key < rhs.key || (!(rhs.key < lhs.key) && lhs.offset < rhs.offset);
+  }
+
+  auto position(entry const & e) -> typename entries_type::iterator {
+    return std::lower_bound(std::begin(_entries), std::end(_entries), e, less);
+  }
+
+  template <typename V> auto lower_bound(V const & v) const -> const_iterator {
+    return std::partition_point(std::cbegin(_entries), std::cend(_entries), [&v](entry const & e) { return e.key < v; });
+  }
+
+  template <typename V> auto upper_bound(V const & v) const -> const_iterator {
+    return std::partition_point(std::cbegin(_entries), std::cend(_entries), [&v](entry const & e) { return !(v < e.key); });
+  }
+
+  P _projection;
+  entries_type _entries;
+};
+
+} // namespace het::details
+
+#endif //HETLIB_FRACTION_INDEX_H
@@ -0,0 +1,247 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_GENERATOR_H
+#define HETLIB_GENERATOR_H
+
+#include "joined_view.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace het {
+
+/**
+ * \brief Lazy input range of the values yielded by a coroutine
+ * \tparam Ref type of the yielded values, the iterators return them by const reference
+ * \details the coroutine runs up to the first co_yield on begin() and up to the next one on the increment of
+ * the iterator, so the generator keeps its position: begin() called again continues from the current value
+ * without rerunning the coroutine, e.g. `gen | std::views::take(n)` pages through the values n at a time.
+ * The coroutine frame is allocated from the memory resource passed as the argument following std::allocator_arg,
+ * from std::pmr::get_default_resource() if there is none.
+ */
+template <typename Ref> class generator {
+public:
+  class promise_type {
+  public:
+    [[nodiscard]] generator get_return_object() noexcept {
+      return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    std::suspend_always final_suspend() const noexcept { return {}; }
+
+    // the operand of co_yield outlives the suspension, it's destroyed at the end of the co_yield expression
+    std::suspend_always yield_value(Ref const & value) noexcept {
+      _value = std::addressof(value);
+      return {};
+    }
+
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept { _error = std::current_exception(); }
+
+    template <typename U> void await_transform(U &&) = delete;
+
+    static void * operator new(std::size_t size) {
+      return allocate(std::pmr::get_default_resource(), size);
+    }
+
+    template <typename... Args> static void * operator new(std::size_t size, Args const &... args) {
+      return allocate(resource_of(args...), size);
+    }
+
+    static void operator delete(void * frame, std::size_t size) noexcept {
+      auto resource = *reinterpret_cast<std::pmr::memory_resource **>(static_cast<std::byte *>(frame) + header_offset(size));
+      resource->deallocate(frame, header_offset(size) + sizeof(std::pmr::memory_resource *), alignof(std::max_align_t));
+    }
+
+  private:
+    friend generator;
+
+    // the resource is stored past the frame, operator delete gets the same size as operator new
+    [[nodiscard]] static constexpr std::size_t header_offset(std::size_t size) noexcept {
+      constexpr auto align = alignof(std::pmr::memory_resource *);
+      return (size + align - 1) / align * align;
+    }
+
+    [[nodiscard]] static void * allocate(std::pmr::memory_resource * resource, std::size_t size) {
+      auto frame = resource->allocate(header_offset(size) + sizeof(std::pmr::memory_resource *), alignof(std::max_align_t));
+      ::new(static_cast<std::byte *>(frame) + header_offset(size)) std::pmr::memory_resource *(resource);
+      return frame;
+    }
+
+    [[nodiscard]] static std::pmr::memory_resource * resource_of() noexcept {
+      return std::pmr::get_default_resource();
+    }
+
+    template <typename A, typename... Args> [[nodiscard]] static std::pmr::memory_resource * resource_of(A const &, Args const &... args) noexcept {
+      if constexpr(std::is_same_v<A, std::allocator_arg_t> && sizeof...(Args) > 0) {
+        return resource_arg(args...);
+      } else {
+        return resource_of(args...);
+      }
+    }
+
+    template <typename R, typename... Args> [[nodiscard]] static std::pmr::memory_resource * resource_arg(R const & resource, Args const &...) noexcept {
+      if constexpr(std::is_convertible_v<R const &, std::pmr::memory_resource *>) {
+        std::pmr::memory_resource * r = resource;
+        return r != nullptr ? r : std::pmr::get_default_resource();
+      } else {
+        return std::pmr::get_default_resource();
+      }
+    }
+
+    void rethrow_if_failed() {
+      if(_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+      }
+    }
+
+    Ref const * _value = nullptr;
+    std::exception_ptr _error;
+  };
+
+  class iterator {
+  public:
+    using value_type = std::remove_cvref_t<Ref>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+
+    [[nodiscard]] Ref const & operator*() const {
+      return *_handle.promise()._value;
+    }
+
+    iterator & operator++() {
+      _handle.resume();
+      _handle.promise().rethrow_if_failed();
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    [[nodiscard]] friend bool operator==(iterator const & it, std::default_sentinel_t) noexcept {
+      return !it._handle || it._handle.done();
+    }
+
+  private:
+    friend generator;
+
+    explicit iterator(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+    std::coroutine_handle<promise_type> _handle;
+  };
+
+  generator() = default;
+
+  generator(generator && other) noexcept
+    : _handle(std::exchange(other._handle, nullptr)), _started(std::exchange(other._started, false)) {}
+
+  generator & operator=(generator && other) noexcept {
+    if(this != &other) {
+      destroy();
+      _handle = std::exchange(other._handle, nullptr);
+      _started = std::exchange(other._started, false);
+    }
+    return *this;
+  }
+
+  ~generator() {
+    destroy();
+  }
+
+  /// \brief Starts the coroutine on the first call, the following calls continue from the current value
+  [[nodiscard]] iterator begin() {
+    if(_handle && !_started) {
+      _started = true;
+      _handle.resume();
+      _handle.promise().rethrow_if_failed();
+    }
+    return iterator(_handle);
+  }
+
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  explicit generator(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+
+  void destroy() noexcept {
+    if(_handle) {
+      _handle.destroy();
+    }
+  }
+
+  std::coroutine_handle<promise_type> _handle;
+  bool _started = false;
+};
+
+namespace details {
+
+/// \brief Yields the elements of the range one by one, the frame is allocated from the resource
+template <std::ranges::input_range R>
+auto generate_range(std::allocator_arg_t, std::pmr::memory_resource *, R range) -> generator<std::ranges::range_value_t<R>> {
+  for(auto && e : range) {
+    co_yield e;
+  }
+}
+
+// appends the elements of the I-th fraction from the position until the batch is full or the fraction ends
+template <std::size_t I, typename Fractions, typename Positions, typename Buffer>
+void fill_batch(Fractions const & fractions, Positions & positions, Buffer & buffer, std::size_t batch) {
+  auto & fr = *std::get<I>(fractions);
+  auto & it = std::get<I>(positions);
+  for(auto last = std::ranges::end(fr); it != last && buffer.size() < batch; ++it) {
+    buffer.emplace_back(std::in_place_index<I>, *it);
+  }
+}
+
+/**
+ * \brief Yields the elements of the fractions in batches of the given size, fraction after fraction, the last
+ * batch may be shorter
+ * \details the batch is a span over the buffer in the frame, it's valid until the generator is resumed; the batch
+ * is filled by a plain loop over the fraction, the coroutine is resumed once per batch
+ */
+template <typename... Cs>
+auto generate_batches(std::allocator_arg_t, std::pmr::memory_resource * resource, std::tuple<Cs *...> fractions, std::size_t batch)
+  -> generator<std::span<typename joined_view<Cs...>::value_type const>> {
+  using value_type = typename joined_view<Cs...>::value_type;
+  std::pmr::vector<value_type> buffer(resource != nullptr ? resource : std::pmr::get_default_resource());
+  batch = batch > 0 ? batch : 1;
+  buffer.reserve(batch);
+  // positions of the missing fractions stay value-initialized and are never used
+  std::tuple<std::ranges::iterator_t<Cs>...> positions;
+  [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+    ((std::get<Is>(fractions) != nullptr ? void(std::get<Is>(positions) = std::ranges::begin(*std::get<Is>(fractions))) : void()), ...);
+  }(std::index_sequence_for<Cs...>{});
+  auto fill = [&]<std::size_t... Is>(std::size_t type, std::index_sequence<Is...>) {
+    ((type == Is && std::get<Is>(fractions) != nullptr ? (fill_batch<Is>(fractions, positions, buffer, batch), true) : false) || ...);
+  };
+  for(std::size_t type = 0; type < sizeof...(Cs); ++type) {
+    for(fill(type, std::index_sequence_for<Cs...>{}); buffer.size() == batch; fill(type, std::index_sequence_for<Cs...>{})) {
+      co_yield std::span<value_type const>(buffer);
+      buffer.clear();
+    }
+  }
+  if(!buffer.empty()) {
+    co_yield std::span<value_type const>(buffer);
+  }
+}
+
+} // namespace details
+
+} // namespace het
+
+#endif //HETLIB_GENERATOR_H
@@ -0,0 +1,151 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_JOIN_H
+#define HETLIB_JOIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <ranges>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace het::details {
+
+/**
+ * \brief Transient hash table over the build side of the join, the elements of equal keys are chained
+ * by their offsets in the fraction order
+ * \tparam K type of the join key
+ */
+template <typename K> class join_table {
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+public:
+  template <typename C, typename P>
+  join_table(C const & c, P const & projection, std::pmr::memory_resource * resource)
+    : _chains(resource), _next(std::size(c), npos, resource) {
+    _chains.reserve(std::size(c));
+    std::size_t offset = 0;
+    for(auto const & e : c) {
+      auto [it, inserted] = _chains.try_emplace(K(std::invoke(projection, e)), chain{offset, offset});
+      if(!inserted) {
+        _next[it->second.last] = offset;
+        it->second.last = offset;
+      }
+      ++offset;
+    }
+  }
+
+  /// \brief Invokes f with the offsets of the elements having the key in the ascending order, stops once f returns false
+  /// \return false if f stopped the lookup
+  template <typename F> bool lookup(K const & key, F && f) const {
+    if(auto it = _chains.find(key); it != _chains.end()) {
+      for(auto offset = it->second.first; offset != npos; offset = _next[offset]) {
+        if(!f(offset)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  struct chain {
+    std::size_t first;
+    std::size_t last;
+  };
+
+  std::pmr::unordered_map<K, chain> _chains;
+  std::pmr::vector<std::size_t> _next;
+};
+
+/// \brief Build side of the join served by the hash index of the fraction, see hetero_container::create_index()
+template <typename Index> class index_lookup {
+public:
+  explicit index_lookup(Index const & index) noexcept : _index(index) {}
+
+  template <typename F> bool lookup(typename Index::key_type const & key, F && f) {
+    // the index keeps the offsets of equal keys in no particular order
+    _offsets.clear();
+    for(auto [first, last] = _index.equal_range(key); first != last; ++first) {
+      _offsets.push_back(first->second);
+    }
+    std::ranges::sort(_offsets);
+    return std::ranges::all_of(_offsets, std::forward<F>(f));
+  }
+
+private:
+  Index const & _index;
+  std::vector<std::size_t> _offsets;
+};
+
+/**
+ * \brief Probes the elements of the fraction in order against the build side of the join
+ * \param emit invoked with the offsets of the probe and of the build elements of equal keys, the build elements
+ *        of the probe element go in the fraction order; the join stops once emit returns false
+ */
+template <typename C, typename P, typename Lookup, typename F>
+void probe_join(C const & probe, P const & projection, Lookup & build, F && emit) {
+  std::size_t offset = 0;
+  for(auto const & e : probe) {
+    if(!build.lookup(std::invoke(projection, e), [&emit, offset](std::size_t match) { return emit(offset, match); })) {
+      return;
+    }
+    ++offset;
+  }
+}
+
+/// \brief Iterators of the fraction elements by their offsets, the iterators of non random access fractions are recorded
+template <typename C> class offset_iterators {
+public:
+  explicit offset_iterators(C & c) : _begin(std::ranges::begin(c)) {
+    if constexpr(!std::ranges::random_access_range<C>) {
+      for(auto it = _begin; it != std::ranges::end(c); ++it) {
+        _iterators.push_back(it);
+      }
+    }
+  }
+
+  [[nodiscard]] std::ranges::iterator_t<C> operator[](std::size_t offset) const {
+    if constexpr(std::ranges::random_access_range<C>) {
+      return std::ranges::next(_begin, static_cast<std::ranges::range_difference_t<C>>(offset));
+    } else {
+      return _iterators[offset];
+    }
+  }
+
+private:
+  std::ranges::iterator_t<C> _begin;
+  std::vector<std::ranges::iterator_t<C>> _iterators;
+};
+
+/**
+ * \brief Nested loop search over the cartesian product of the fractions, the last fraction varies fastest
+ * \param iterators receives the iterators of the first tuple of elements satisfying the predicate
+ * \return true if there is such a tuple
+ */
+template <std::size_t I, typename Fractions, typename Iterators, typename F>
+bool nested_find(Fractions const & fractions, Iterators & iterators, F & f) {
+  auto & fr = *std::get<I>(fractions);
+  for(auto & it = std::get<I>(iterators) = std::ranges::begin(fr); it != std::ranges::end(fr); ++it) {
+    if constexpr(I + 1 == std::tuple_size_v<Iterators>) {
+      if(std::apply([&f](auto const &... its) { return std::invoke(f, *its...); }, iterators)) {
+        return true;
+      }
+    } else if(nested_find<I + 1>(fractions, iterators, f)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace het::details
+
+#endif //HETLIB_JOIN_H
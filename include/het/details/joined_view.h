@@ -0,0 +1,129 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_JOINED_VIEW_H
+#define HETLIB_JOINED_VIEW_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace het::details {
+
+/**
+ * \brief Lazy view over the elements of several fractions, one fraction after another in the order of the types
+ * \tparam Cs types of the fractions, const for the read-only view
+ * \details elements are yielded as std::variant of std::reference_wrapper to the element, the alternative index
+ * is the position of its fraction in Cs...; missing (nullptr) and empty fractions are skipped. The iterators
+ * keep the fraction pointers themselves, so they stay valid while the fractions aren't modified.
+ */
+template <typename... Cs> requires (sizeof...(Cs) > 0)
+class joined_view : public std::ranges::view_interface<joined_view<Cs...>> {
+  static constexpr std::size_t _count = sizeof...(Cs);
+  using fractions_type = std::tuple<Cs *...>;
+
+public:
+  using value_type = std::variant<std::reference_wrapper<std::remove_reference_t<std::ranges::range_reference_t<Cs>>>...>;
+
+  class iterator {
+  public:
+    using value_type = joined_view::value_type;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+
+    iterator() = default;
+
+    [[nodiscard]] value_type operator*() const {
+      return dereference<0>();
+    }
+
+    iterator & operator++() {
+      [this]<std::size_t... Is>(std::index_sequence<Is...>) {
+        ((_current.index() == Is ? (advance<Is>(), true) : false) || ...);
+      }(std::make_index_sequence<_count>{});
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+
+    [[nodiscard]] friend bool operator==(iterator const & lhs, iterator const & rhs) {
+      return lhs._current == rhs._current;
+    }
+
+    [[nodiscard]] friend bool operator==(iterator const & it, std::default_sentinel_t) {
+      return it._current.index() == _count;
+    }
+
+  private:
+    friend joined_view;
+
+    explicit iterator(fractions_type const & fractions) : _fractions(fractions) {
+      seek<0>();
+    }
+
+    template <std::size_t I> value_type dereference() const {
+      if constexpr(I + 1 < _count) {
+        if(_current.index() != I) {
+          return dereference<I + 1>();
+        }
+      }
+      return value_type(std::in_place_index<I>, *std::get<I>(_current));
+    }
+
+    // positions at the first element of the I-th or the following non-empty fraction
+    template <std::size_t I> void seek() {
+      if constexpr(I == _count) {
+        _current.template emplace<_count>();
+      } else if(auto fr = std::get<I>(_fractions); fr != nullptr && !std::ranges::empty(*fr)) {
+        _current.template emplace<I>(std::ranges::begin(*fr));
+      } else {
+        seek<I + 1>();
+      }
+    }
+
+    template <std::size_t I> void advance() {
+      if(++std::get<I>(_current) == std::ranges::end(*std::get<I>(_fractions))) {
+        seek<I + 1>();
+      }
+    }
+
+    fractions_type _fractions{};
+    // iterator into the fraction of the alternative index, monostate past the end
+    std::variant<std::ranges::iterator_t<Cs>..., std::monostate> _current{std::in_place_index<_count>};
+  };
+
+  joined_view() = default;
+  explicit joined_view(Cs *... fractions) noexcept : _fractions(fractions...) {}
+
+  [[nodiscard]] iterator begin() const { return iterator(_fractions); }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+  /// \brief Total number of the elements, O(number of the fractions)
+  [[nodiscard]] std::size_t size() const noexcept {
+    return std::apply([](auto const *... fr) {
+      return (std::size_t{0} + ... + (fr != nullptr ? static_cast<std::size_t>(std::ranges::size(*fr)) : 0));
+    }, _fractions);
+  }
+
+private:
+  fractions_type _fractions{};
+};
+
+} // namespace het::details
+
+namespace std::ranges {
+// the iterators refer to the fractions, not to the view
+template <typename... Cs> inline constexpr bool enable_borrowed_range<het::details::joined_view<Cs...>> = true;
+} // namespace std::ranges
+
+#endif //HETLIB_JOINED_VIEW_H
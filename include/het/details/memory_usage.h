@@ -0,0 +1,101 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_MEMORY_USAGE_H
+#define HETLIB_MEMORY_USAGE_H
+
+#include <cstddef>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace het {
+
+/**
+ * \brief Byte usage split by purpose
+ * \details Element bytes are shallow, i.e. sizeof of every element, memory owned by the elements
+ * themselves (strings, nested containers) is not followed. Node and bucket sizes of the standard
+ * hash maps are estimated as one link pointer per node and one pointer per bucket.
+ */
+struct memory_usage {
+  std::size_t element_bytes = 0;     // elements stored
+  std::size_t slack_bytes = 0;       // reserved but unused capacity
+  std::size_t bookkeeping_bytes = 0; // containers, registry nodes, buckets and indexes
+
+  [[nodiscard]] std::size_t bytes() const noexcept {
+    return element_bytes + slack_bytes + bookkeeping_bytes;
+  }
+
+  memory_usage & operator+=(memory_usage const & other) noexcept {
+    element_bytes += other.element_bytes;
+    slack_bytes += other.slack_bytes;
+    bookkeeping_bytes += other.bookkeeping_bytes;
+    return *this;
+  }
+
+  friend bool operator==(memory_usage const &, memory_usage const &) = default;
+};
+
+/// \brief Byte usage of the elements of a single registered type
+struct type_memory_usage {
+  std::type_index type;                 // element (value) type
+  std::type_index key = typeid(void);   // key type of hetero_key_value, void otherwise
+  std::size_t count = 0;                // number of elements
+  memory_usage usage;
+};
+
+/// \brief Byte usage of the object, total includes the per-type usage and the per-object bookkeeping
+struct memory_report {
+  memory_usage total;
+  std::vector<type_memory_usage> types;
+};
+
+/// \brief Process-wide state of the static registry of a single type
+struct registry_statistics {
+  std::size_t size = 0;          // number of owners having values of the type
+  std::size_t bucket_count = 0;
+  float load_factor = 0.f;
+  std::size_t bytes = 0;         // estimated nodes and buckets bytes, elements of the owners excluded
+};
+
+namespace details {
+
+// estimated size of the hash map node keeping the value
+template <typename Map> constexpr std::size_t node_bytes = sizeof(void *) + sizeof(typename Map::value_type);
+
+template <typename Map> [[nodiscard]] registry_statistics statistics_of(Map const & map) {
+  registry_statistics s;
+  s.size = map.size();
+  s.bucket_count = map.bucket_count();
+  s.load_factor = s.bucket_count == 0 ? 0.f : static_cast<float>(s.size) / static_cast<float>(s.bucket_count);
+  s.bytes = s.size * node_bytes<Map> + s.bucket_count * sizeof(void *);
+  return s;
+}
+
+/**
+ * \brief Estimates usage of the container of type T elements along with the container object itself
+ * \details contiguous containers report their unused capacity as slack, unused inline storage of small_vector
+ * is slack as well, hash maps report nodes and buckets and slot_map its slot tables as bookkeeping
+ */
+template <typename T, typename C> [[nodiscard]] memory_usage usage_of(C const & c) {
+  memory_usage u{c.size() * sizeof(T), 0, sizeof(C)};
+  if constexpr(requires { c.bucket_count(); }) {
+    u.bookkeeping_bytes += c.size() * (node_bytes<C> - sizeof(T)) + c.bucket_count() * sizeof(void *);
+  } else if constexpr(requires { C::inline_capacity; c.is_inline(); }) {
+    u.bookkeeping_bytes -= C::inline_capacity * sizeof(T);
+    u.slack_bytes = (c.capacity() - c.size() + (c.is_inline() ? 0 : C::inline_capacity)) * sizeof(T);
+  } else if constexpr(requires { c.capacity(); }) {
+    u.slack_bytes = (c.capacity() - c.size()) * sizeof(T);
+  }
+  if constexpr(requires { c.index_bytes(); }) {
+    u.bookkeeping_bytes += c.index_bytes();
+  }
+  return u;
+}
+
+} // namespace details
+
+} // namespace het
+
+#endif //HETLIB_MEMORY_USAGE_H
@@ -0,0 +1,95 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_PARALLEL_H
+#define HETLIB_PARALLEL_H
+
+#include "task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <vector>
+
+namespace het {
+
+/**
+ * \brief Execution policy of the parallel algorithms (visit_par, match_par, find_all, count_if)
+ * \details fractions of different types run concurrently, fractions larger than grain elements are split
+ * into chunks of grain elements
+ */
+struct parallel_policy {
+  // scheduler running the chunks, nullptr stands for task_scheduler::shared()
+  task_scheduler * scheduler = nullptr;
+  // elements per chunk of the fraction
+  std::size_t grain = std::size_t{1} << 14;
+  // find_all() keeps the fraction order of the results
+  bool ordered = true;
+
+  [[nodiscard]] task_scheduler & executor() const {
+    return scheduler != nullptr ? *scheduler : task_scheduler::shared();
+  }
+};
+
+namespace details {
+
+/// \brief Chunks per thread find_all() splits the fraction into at most, enough to balance the load
+inline constexpr std::size_t chunks_per_thread = 8;
+
+/// \brief Chunk of the fraction of the I-th visited type, elements [first, last)
+struct fraction_chunk {
+  std::size_t type;
+  std::size_t first;
+  std::size_t last;
+};
+
+/// \brief Cooperative cancellation of the parallel run, workers check it between the elements
+class cancellation {
+public:
+  void request() noexcept { _requested.store(true, std::memory_order_relaxed); }
+  [[nodiscard]] bool requested() const noexcept { return _requested.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<bool> _requested{false};
+};
+
+/**
+ * \brief Runs the tasks on the scheduler of the policy, the calling thread takes part
+ * \param task function invoked with the task number for every task in [0, tasks)
+ * \param cancel cancellation requested when the task throws, the rest of the tasks are skipped
+ * \throw rethrows the first exception thrown by the tasks once all the running tasks are complete
+ */
+template <typename F> void run_parallel(parallel_policy const & policy, std::size_t tasks, F && task, cancellation & cancel) {
+  policy.executor().parallel_for(0, tasks, 1, [&](std::size_t first, std::size_t last) {
+    for(; first < last && !cancel.requested(); ++first) {
+      try {
+        task(first);
+      } catch(...) {
+        cancel.request();
+        throw;
+      }
+    }
+  });
+}
+
+/**
+ * \brief Bounds of the chunks of grain elements, recorded in a single pass over the range
+ * \return iterators to the first element of every chunk followed by the end of the range
+ */
+template <std::ranges::forward_range R> auto chunk_bounds(R & range, std::size_t grain) -> std::vector<std::ranges::iterator_t<R>> {
+  std::vector<std::ranges::iterator_t<R>> bounds{std::ranges::begin(range)};
+  for(auto it = std::ranges::begin(range); it != std::ranges::end(range);) {
+    it = std::ranges::next(it, static_cast<std::ranges::range_difference_t<R>>(std::max<std::size_t>(grain, 1)), std::ranges::end(range));
+    bounds.push_back(it);
+  }
+  return bounds;
+}
+
+} // namespace details
+
+} // namespace het
+
+#endif //HETLIB_PARALLEL_H
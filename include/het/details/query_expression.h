@@ -0,0 +1,158 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_QUERY_EXPRESSION_H
+#define HETLIB_QUERY_EXPRESSION_H
+
+#include "domains.h"
+
+#include <concepts>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace het {
+
+/**
+ * \brief Expression of the query DSL, a predicate over the elements which is built at compile time
+ * \details `where(field(&T::a) == 5 && field(&T::b) < 3 || !(field(&T::c) == "x"))` is a single function object
+ * evaluated with short-circuiting, so it's accepted wherever a predicate is (find_first, find_all, erase_if).
+ * clauses() lists the comparisons of the top-level conjunction as projection clauses, query_first and
+ * query_last look them up through the indexes of the container.
+ */
+template <typename E> concept query_expression = requires { E::is_query_expression; };
+
+template <typename P, typename Op, typename V> struct compare_expression {
+  static constexpr bool is_query_expression = true;
+
+  P projection;
+  V value;
+
+  template <typename Obj> [[nodiscard]] constexpr bool operator()(Obj const & obj) const {
+    return Op{}(std::invoke(projection, obj), value);
+  }
+
+  // equality and ordering comparisons are clauses the indexes serve, inequality is not
+  [[nodiscard]] constexpr auto clauses() const {
+    if constexpr(std::same_as<Op, std::equal_to<>>) {
+      return std::make_tuple(std::pair{projection, value});
+    } else if constexpr(std::same_as<Op, std::less<>>) {
+      return std::make_tuple(lt(projection, value));
+    } else if constexpr(std::same_as<Op, std::less_equal<>>) {
+      return std::make_tuple(le(projection, value));
+    } else if constexpr(std::same_as<Op, std::greater<>>) {
+      return std::make_tuple(gt(projection, value));
+    } else if constexpr(std::same_as<Op, std::greater_equal<>>) {
+      return std::make_tuple(ge(projection, value));
+    } else {
+      return std::tuple{};
+    }
+  }
+};
+
+template <query_expression L, query_expression R> struct and_expression {
+  static constexpr bool is_query_expression = true;
+
+  L lhs;
+  R rhs;
+
+  template <typename Obj> [[nodiscard]] constexpr bool operator()(Obj const & obj) const {
+    return lhs(obj) && rhs(obj);
+  }
+
+  [[nodiscard]] constexpr auto clauses() const {
+    return std::tuple_cat(lhs.clauses(), rhs.clauses());
+  }
+};
+
+template <query_expression L, query_expression R> struct or_expression {
+  static constexpr bool is_query_expression = true;
+
+  L lhs;
+  R rhs;
+
+  template <typename Obj> [[nodiscard]] constexpr bool operator()(Obj const & obj) const {
+    return lhs(obj) || rhs(obj);
+  }
+
+  [[nodiscard]] constexpr auto clauses() const {
+    return std::tuple{};
+  }
+};
+
+template <query_expression E> struct not_expression {
+  static constexpr bool is_query_expression = true;
+
+  E expression;
+
+  template <typename Obj> [[nodiscard]] constexpr bool operator()(Obj const & obj) const {
+    return !expression(obj);
+  }
+
+  [[nodiscard]] constexpr auto clauses() const {
+    return std::tuple{};
+  }
+};
+
+/// \brief Projection of the element taking part in the query expression, compare it to get the expression
+template <typename P> struct field_expression {
+  P projection;
+
+  template <typename V> friend constexpr auto operator==(field_expression f, V value) {
+    return compare_expression<P, std::equal_to<>, V>{f.projection, std::move(value)};
+  }
+
+  template <typename V> friend constexpr auto operator!=(field_expression f, V value) {
+    return compare_expression<P, std::not_equal_to<>, V>{f.projection, std::move(value)};
+  }
+
+  template <typename V> friend constexpr auto operator<(field_expression f, V value) {
+    return compare_expression<P, std::less<>, V>{f.projection, std::move(value)};
+  }
+
+  template <typename V> friend constexpr auto operator<=(field_expression f, V value) {
+    return compare_expression<P, std::less_equal<>, V>{f.projection, std::move(value)};
+  }
+
+  template <typename V> friend constexpr auto operator>(field_expression f, V value) {
+    return compare_expression<P, std::greater<>, V>{f.projection, std::move(value)};
+  }
+
+  template <typename V> friend constexpr auto operator>=(field_expression f, V value) {
+    return compare_expression<P, std::greater_equal<>, V>{f.projection, std::move(value)};
+  }
+};
+
+/// \brief Refers to the element projection, pointer to the data member or to the getter, in the query expression
+template <typename P> constexpr auto field(P projection) {
+  return field_expression<P>{projection};
+}
+
+/// \brief Refers to the element itself, comparisons of arithmetic elements against constants of their type are
+/// evaluated by the vector scan kernels
+constexpr auto element() {
+  return field_expression<std::identity>{};
+}
+
+/// \brief Marks the query expression, the expression itself is the predicate
+template <query_expression E> constexpr E where(E expression) {
+  return expression;
+}
+
+template <query_expression L, query_expression R> constexpr auto operator&&(L lhs, R rhs) {
+  return and_expression<L, R>{std::move(lhs), std::move(rhs)};
+}
+
+template <query_expression L, query_expression R> constexpr auto operator||(L lhs, R rhs) {
+  return or_expression<L, R>{std::move(lhs), std::move(rhs)};
+}
+
+template <query_expression E> constexpr auto operator!(E expression) {
+  return not_expression<E>{std::move(expression)};
+}
+
+} // namespace het
+
+#endif //HETLIB_QUERY_EXPRESSION_H
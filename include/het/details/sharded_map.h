@@ -0,0 +1,277 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_SHARDED_MAP_H
+#define HETLIB_SHARDED_MAP_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace het {
+
+/**
+ * \brief Hash map split into independently locked shards, usable as the registry policy of
+ * hetero_container, hetero_value and hetero_key_value
+ * \tparam K key type
+ * \tparam V mapped type
+ * \details Each key lives in the shard selected by its mixed hash, so operations over different
+ * keys (i.e. different owner instances) mostly take different locks. Mapped values are node based,
+ * references to them stay valid after the shard lock is released.
+ * \attention only the map structure is guarded: concurrent access to the same key (the same owner
+ * instance) must be synchronized by the caller, iteration is not atomic against concurrent writers
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class sharded_map {
+  using map_type = std::unordered_map<K, V, Hash, KeyEqual>;
+
+public:
+  static constexpr std::size_t shards_count = 16;
+
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = typename map_type::value_type;
+  using size_type = std::size_t;
+  using node_type = typename map_type::node_type;
+
+  /// \brief Per-owner map type used by registries nesting a map into every entry, the owner is never shared
+  using owner_map_type = map_type;
+
+  template <bool Const> class basic_iterator {
+    using owner_type = std::conditional_t<Const, sharded_map const, sharded_map>;
+    using inner_iterator = std::conditional_t<Const, typename map_type::const_iterator, typename map_type::iterator>;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename map_type::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, value_type const *, value_type *>;
+    using reference = std::conditional_t<Const, value_type const &, value_type &>;
+
+    basic_iterator() = default;
+    basic_iterator(owner_type * owner, std::size_t shard, inner_iterator it) : _owner(owner), _shard(shard), _it(it) {
+      skip_empty();
+    }
+    template <bool C> requires (Const && !C)
+    basic_iterator(basic_iterator<C> const & it) : _owner(it._owner), _shard(it._shard), _it(it._it) {}
+
+    reference operator*() const { return *_it; }
+    pointer operator->() const { return &*_it; }
+
+    basic_iterator & operator++() {
+      ++_it;
+      skip_empty();
+      return *this;
+    }
+
+    basic_iterator operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+
+    friend bool operator==(basic_iterator const & lhs, basic_iterator const & rhs) {
+      return lhs._shard == rhs._shard && (lhs._shard == shards_count || lhs._it == rhs._it);
+    }
+
+  private:
+    template <bool> friend class basic_iterator;
+
+    void skip_empty() {
+      while(_shard < shards_count && _it == _owner->_shards[_shard].map.end()) {
+        if(++_shard < shards_count) {
+          _it = _owner->_shards[_shard].map.begin();
+        }
+      }
+    }
+
+    owner_type * _owner = nullptr;
+    std::size_t _shard = shards_count;
+    inner_iterator _it{};
+  };
+
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  sharded_map() = default;
+
+  sharded_map(sharded_map const & other) {
+    for(std::size_t i = 0; i < shards_count; ++i) {
+      std::scoped_lock lock(other._shards[i].lock);
+      _shards[i].map = other._shards[i].map;
+    }
+  }
+
+  sharded_map(sharded_map && other) noexcept {
+    for(std::size_t i = 0; i < shards_count; ++i) {
+      std::scoped_lock lock(other._shards[i].lock);
+      _shards[i].map = std::move(other._shards[i].map);
+    }
+  }
+
+  sharded_map & operator=(sharded_map const & other) {
+    if(&other != this) {
+      for(std::size_t i = 0; i < shards_count; ++i) {
+        std::scoped_lock lock(_shards[i].lock, other._shards[i].lock);
+        _shards[i].map = other._shards[i].map;
+      }
+    }
+    return *this;
+  }
+
+  sharded_map & operator=(sharded_map && other) noexcept {
+    if(&other != this) {
+      for(std::size_t i = 0; i < shards_count; ++i) {
+        std::scoped_lock lock(_shards[i].lock, other._shards[i].lock);
+        _shards[i].map = std::move(other._shards[i].map);
+      }
+    }
+    return *this;
+  }
+
+  [[nodiscard]] iterator begin() { return {this, 0, _shards[0].map.begin()}; }
+  [[nodiscard]] iterator end() { return {}; }
+  [[nodiscard]] const_iterator begin() const { return {this, 0, _shards[0].map.begin()}; }
+  [[nodiscard]] const_iterator end() const { return {}; }
+  [[nodiscard]] const_iterator cbegin() const { return begin(); }
+  [[nodiscard]] const_iterator cend() const { return end(); }
+
+  [[nodiscard]] iterator find(K const & key) {
+    auto idx = shard_of(key);
+    auto & s = _shards[idx];
+    std::scoped_lock lock(s.lock);
+    if(auto it = s.map.find(key); it != s.map.end()) {
+      return {this, idx, it};
+    }
+    return end();
+  }
+
+  [[nodiscard]] const_iterator find(K const & key) const {
+    auto idx = shard_of(key);
+    auto & s = _shards[idx];
+    std::scoped_lock lock(s.lock);
+    if(auto it = s.map.find(key); it != s.map.end()) {
+      return {this, idx, it};
+    }
+    return end();
+  }
+
+  [[nodiscard]] bool contains(K const & key) const {
+    auto & s = _shards[shard_of(key)];
+    std::scoped_lock lock(s.lock);
+    return s.map.contains(key);
+  }
+
+  [[nodiscard]] V & at(K const & key) {
+    auto & s = _shards[shard_of(key)];
+    std::scoped_lock lock(s.lock);
+    return s.map.at(key);
+  }
+
+  [[nodiscard]] V const & at(K const & key) const {
+    auto & s = _shards[shard_of(key)];
+    std::scoped_lock lock(s.lock);
+    return s.map.at(key);
+  }
+
+  V & operator[](K const & key) {
+    auto & s = _shards[shard_of(key)];
+    std::scoped_lock lock(s.lock);
+    return s.map[key];
+  }
+
+  template <typename M> std::pair<iterator, bool> insert_or_assign(K const & key, M && value) {
+    auto idx = shard_of(key);
+    auto & s = _shards[idx];
+    std::scoped_lock lock(s.lock);
+    auto [it, inserted] = s.map.insert_or_assign(key, std::forward<M>(value));
+    return {iterator{this, idx, it}, inserted};
+  }
+
+  template <typename... Args> std::pair<iterator, bool> try_emplace(K const & key, Args &&... args) {
+    auto idx = shard_of(key);
+    auto & s = _shards[idx];
+    std::scoped_lock lock(s.lock);
+    auto [it, inserted] = s.map.try_emplace(key, std::forward<Args>(args)...);
+    return {iterator{this, idx, it}, inserted};
+  }
+
+  size_type erase(K const & key) {
+    auto & s = _shards[shard_of(key)];
+    std::scoped_lock lock(s.lock);
+    return s.map.erase(key);
+  }
+
+  [[nodiscard]] node_type extract(K const & key) {
+    auto & s = _shards[shard_of(key)];
+    std::scoped_lock lock(s.lock);
+    return s.map.extract(key);
+  }
+
+  /// \brief Inserts an extracted node into the shard of its (possibly re-assigned) key
+  bool insert(node_type && node) {
+    if(node.empty()) {
+      return false;
+    }
+    auto & s = _shards[shard_of(node.key())];
+    std::scoped_lock lock(s.lock);
+    return s.map.insert(std::move(node)).inserted;
+  }
+
+  [[nodiscard]] size_type size() const {
+    size_type sz = 0;
+    for(auto && s : _shards) {
+      std::scoped_lock lock(s.lock);
+      sz += s.map.size();
+    }
+    return sz;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return size() == 0;
+  }
+
+  [[nodiscard]] size_type bucket_count() const {
+    size_type n = 0;
+    for(auto && s : _shards) {
+      std::scoped_lock lock(s.lock);
+      n += s.map.bucket_count();
+    }
+    return n;
+  }
+
+  void clear() {
+    for(auto && s : _shards) {
+      std::scoped_lock lock(s.lock);
+      s.map.clear();
+    }
+  }
+
+private:
+  // fibonacci hashing over the full hash, std::hash of pointers is the identity with always-zero low bits
+  [[nodiscard]] static std::size_t shard_of(K const & key) {
+    static_assert((shards_count & (shards_count - 1)) == 0, "shards count must be a power of two");
+    auto h = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(h >> (64 - std::countr_zero(shards_count)));
+  }
+
+  // separate cache lines keep threads working on different shards from contending on the lock words
+  struct alignas(64) shard {
+    mutable std::mutex lock;
+    map_type map;
+  };
+
+  std::array<shard, shards_count> _shards;
+};
+
+} // namespace het
+
+#endif //HETLIB_SHARDED_MAP_H
@@ -0,0 +1,544 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_SIMD_SCAN_H
+#define HETLIB_SIMD_SCAN_H
+
+#include "domains.h"
+#include "query_expression.h"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__)
+#define HETLIB_ALWAYS_INLINE __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define HETLIB_ALWAYS_INLINE __forceinline
+#else
+#define HETLIB_ALWAYS_INLINE
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HETLIB_SIMD_SSE2 1
+#include <immintrin.h>
+#if defined(__GNUC__)
+// AVX2 kernels are compiled for the target attribute and picked at runtime, so the library builds without -mavx2
+#define HETLIB_SIMD_AVX2 1
+#define HETLIB_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace het::details {
+
+/// \brief Element types the scan kernels handle, signed 8 and 32 bit integers, float and double
+template <typename T> concept scan_element =
+    (std::is_integral_v<T> && std::is_signed_v<T> && (sizeof(T) == 1 || sizeof(T) == 4)) ||
+    std::same_as<T, float> || std::same_as<T, double>;
+
+/**
+ * \brief Comparison of the element against constants, the element matches if it's within the range xor negate
+ * \details closed bounds of the comparison operators are ordered, x >= lo, the ones of the range clauses are
+ * the negated comparison !(x < lo), so both sorts evaluate the unordered (NaN) elements as the scalar code does
+ */
+template <typename T> struct scan_predicate {
+  bounds<T> range;
+  bool negate = false;
+  bool ordered = false;
+
+  [[nodiscard]] constexpr bool operator()(T const & value) const {
+    if(!ordered) {
+      return range.contains(value) != negate;
+    }
+    auto & [lo, hi, lo_open, hi_open] = range;
+    return ((!lo || (lo_open ? *lo < value : value >= *lo)) && (!hi || (hi_open ? value < *hi : *hi >= value))) != negate;
+  }
+};
+
+// intersection of the ranges, nullopt if the bounds are unordered (NaN)
+template <typename T> constexpr auto intersect(scan_predicate<T> const & a, scan_predicate<T> const & b)
+    -> std::optional<scan_predicate<T>> {
+  auto pick = [](std::optional<T> const & x, bool xo, std::optional<T> const & y, bool yo, bool lower, std::optional<T> & v, bool & o) {
+    if(!x || !y) {
+      v = x ? x : y;
+      o = x ? xo : yo;
+      return true;
+    }
+    if(*x < *y || *y < *x) {
+      bool take_y = lower ? *x < *y : *y < *x;
+      v = take_y ? y : x;
+      o = take_y ? yo : xo;
+      return true;
+    }
+    v = x;
+    o = xo || yo;
+    return *x == *y;
+  };
+  scan_predicate<T> r{{}, false, a.ordered && b.ordered};
+  if(!pick(a.range.lo, a.range.lo_open, b.range.lo, b.range.lo_open, true, r.range.lo, r.range.lo_open) ||
+     !pick(a.range.hi, a.range.hi_open, b.range.hi, b.range.hi_open, false, r.range.hi, r.range.hi_open)) {
+    return std::nullopt;
+  }
+  return r;
+}
+
+/**
+ * \brief Recognizes the predicate the scan kernels evaluate
+ * \details comparisons of the element itself (element(), std::identity projection) against the constant of the element
+ * type, conjunctions and negations of them, and the projection clauses of std::identity
+ */
+template <typename T, typename F> struct scan_recognizer {
+  static constexpr bool value = false;
+  static constexpr bool negated = false;
+};
+
+template <typename T, typename Op> struct scan_recognizer<T, compare_expression<std::identity, Op, T>> {
+  static constexpr bool value = true;
+  static constexpr bool negated = std::same_as<Op, std::not_equal_to<>>;
+
+  static constexpr auto of(compare_expression<std::identity, Op, T> const & e) -> std::optional<scan_predicate<T>> {
+    if constexpr(std::same_as<Op, std::equal_to<>> || std::same_as<Op, std::not_equal_to<>>) {
+      return scan_predicate<T>{bounds<T>{e.value, e.value}, negated, true};
+    } else if constexpr(std::same_as<Op, std::less<>>) {
+      return scan_predicate<T>{bounds<T>{std::nullopt, e.value, false, true}, false, true};
+    } else if constexpr(std::same_as<Op, std::less_equal<>>) {
+      return scan_predicate<T>{bounds<T>{std::nullopt, e.value, false, false}, false, true};
+    } else if constexpr(std::same_as<Op, std::greater<>>) {
+      return scan_predicate<T>{bounds<T>{e.value, std::nullopt, true, false}, false, true};
+    } else {
+      return scan_predicate<T>{bounds<T>{e.value, std::nullopt, false, false}, false, true};
+    }
+  }
+};
+
+template <typename T, typename L, typename R> struct scan_recognizer<T, and_expression<L, R>> {
+  static constexpr bool value = scan_recognizer<T, L>::value && scan_recognizer<T, R>::value &&
+                                !scan_recognizer<T, L>::negated && !scan_recognizer<T, R>::negated;
+  static constexpr bool negated = false;
+
+  static constexpr auto of(and_expression<L, R> const & e) -> std::optional<scan_predicate<T>> {
+    auto l = scan_recognizer<T, L>::of(e.lhs);
+    auto r = scan_recognizer<T, R>::of(e.rhs);
+    return l && r ? intersect(*l, *r) : std::nullopt;
+  }
+};
+
+template <typename T, typename E> struct scan_recognizer<T, not_expression<E>> {
+  static constexpr bool value = scan_recognizer<T, E>::value;
+  static constexpr bool negated = !scan_recognizer<T, E>::negated;
+
+  static constexpr auto of(not_expression<E> const & e) -> std::optional<scan_predicate<T>> {
+    auto p = scan_recognizer<T, E>::of(e.expression);
+    if(p) {
+      p->negate = !p->negate;
+    }
+    return p;
+  }
+};
+
+template <typename T, typename V> struct scan_recognizer<T, std::pair<std::identity, V>> {
+  static constexpr bool value = std::same_as<V, T> || std::same_as<V, bounds<T>>;
+  static constexpr bool negated = false;
+
+  static constexpr auto of(std::pair<std::identity, V> const & c) -> std::optional<scan_predicate<T>> {
+    if constexpr(std::same_as<V, T>) {
+      return scan_predicate<T>{bounds<T>{c.second, c.second}, false, true};
+    } else {
+      return scan_predicate<T>{c.second};
+    }
+  }
+};
+
+template <typename T, typename F> inline constexpr bool is_scannable =
+    scan_element<T> && scan_recognizer<T, std::remove_cvref_t<F>>::value;
+
+// scalar kernels, also process the tails of the vector ones
+template <typename T> std::size_t scan_first_scalar(T const * data, std::size_t from, std::size_t n, scan_predicate<T> const & p) {
+  for(; from < n; ++from) {
+    if(p(data[from])) {
+      break;
+    }
+  }
+  return from;
+}
+
+template <typename T> void scan_bitmap_scalar(T const * data, std::size_t from, std::size_t n, scan_predicate<T> const & p, std::uint64_t * bits) {
+  for(; from < n; ++from) {
+    bits[from / 64] |= std::uint64_t{p(data[from])} << (from % 64);
+  }
+}
+
+#if defined(HETLIB_SIMD_SSE2)
+
+// lanes of the 128-bit vector, comparison results are all-ones lanes
+template <typename T> struct sse2_lanes;
+
+template <> struct sse2_lanes<std::int8_t> {
+  using vector = __m128i;
+  static vector load(std::int8_t const * p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+  static vector set1(std::int8_t v) { return _mm_set1_epi8(v); }
+  static vector gt(vector a, vector b) { return _mm_cmpgt_epi8(a, b); }
+  static vector ge(vector a, vector b) { return _mm_xor_si128(_mm_cmpgt_epi8(b, a), _mm_set1_epi8(-1)); }
+  static vector nlt(vector a, vector b) { return ge(a, b); }
+  static vector both(vector a, vector b) { return _mm_and_si128(a, b); }
+  static vector all() { return _mm_set1_epi8(-1); }
+  static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm_movemask_epi8(v)); }
+};
+
+template <> struct sse2_lanes<std::int32_t> {
+  using vector = __m128i;
+  static vector load(std::int32_t const * p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+  static vector set1(std::int32_t v) { return _mm_set1_epi32(v); }
+  static vector gt(vector a, vector b) { return _mm_cmpgt_epi32(a, b); }
+  static vector ge(vector a, vector b) { return _mm_xor_si128(_mm_cmpgt_epi32(b, a), _mm_set1_epi32(-1)); }
+  static vector nlt(vector a, vector b) { return ge(a, b); }
+  static vector both(vector a, vector b) { return _mm_and_si128(a, b); }
+  static vector all() { return _mm_set1_epi32(-1); }
+  static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(v))); }
+};
+
+template <> struct sse2_lanes<float> {
+  using vector = __m128;
+  static vector load(float const * p) { return _mm_loadu_ps(p); }
+  static vector set1(float v) { return _mm_set1_ps(v); }
+  static vector gt(vector a, vector b) { return _mm_cmpgt_ps(a, b); }
+  static vector ge(vector a, vector b) { return _mm_cmpge_ps(a, b); }
+  static vector nlt(vector a, vector b) { return _mm_cmpnlt_ps(a, b); }
+  static vector both(vector a, vector b) { return _mm_and_ps(a, b); }
+  static vector all() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+  static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm_movemask_ps(v)); }
+};
+
+template <> struct sse2_lanes<double> {
+  using vector = __m128d;
+  static vector load(double const * p) { return _mm_loadu_pd(p); }
+  static vector set1(double v) { return _mm_set1_pd(v); }
+  static vector gt(vector a, vector b) { return _mm_cmpgt_pd(a, b); }
+  static vector ge(vector a, vector b) { return _mm_cmpge_pd(a, b); }
+  static vector nlt(vector a, vector b) { return _mm_cmpnlt_pd(a, b); }
+  static vector both(vector a, vector b) { return _mm_and_pd(a, b); }
+  static vector all() { return _mm_castsi128_pd(_mm_set1_epi32(-1)); }
+  static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm_movemask_pd(v)); }
+};
+
+#endif
+
+#if defined(HETLIB_SIMD_AVX2)
+
+// lanes of the 256-bit vector, every member carries the target attribute so the kernels inline them
+template <typename T> struct avx2_lanes;
+
+template <> struct avx2_lanes<std::int8_t> {
+  using vector = __m256i;
+  HETLIB_TARGET_AVX2 static vector load(std::int8_t const * p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+  HETLIB_TARGET_AVX2 static vector set1(std::int8_t v) { return _mm256_set1_epi8(v); }
+  HETLIB_TARGET_AVX2 static vector gt(vector a, vector b) { return _mm256_cmpgt_epi8(a, b); }
+  HETLIB_TARGET_AVX2 static vector ge(vector a, vector b) { return _mm256_xor_si256(_mm256_cmpgt_epi8(b, a), _mm256_set1_epi8(-1)); }
+  HETLIB_TARGET_AVX2 static vector nlt(vector a, vector b) { return ge(a, b); }
+  HETLIB_TARGET_AVX2 static vector both(vector a, vector b) { return _mm256_and_si256(a, b); }
+  HETLIB_TARGET_AVX2 static vector all() { return _mm256_set1_epi8(-1); }
+  HETLIB_TARGET_AVX2 static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm256_movemask_epi8(v)); }
+};
+
+template <> struct avx2_lanes<std::int32_t> {
+  using vector = __m256i;
+  HETLIB_TARGET_AVX2 static vector load(std::int32_t const * p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+  HETLIB_TARGET_AVX2 static vector set1(std::int32_t v) { return _mm256_set1_epi32(v); }
+  HETLIB_TARGET_AVX2 static vector gt(vector a, vector b) { return _mm256_cmpgt_epi32(a, b); }
+  HETLIB_TARGET_AVX2 static vector ge(vector a, vector b) { return _mm256_xor_si256(_mm256_cmpgt_epi32(b, a), _mm256_set1_epi32(-1)); }
+  HETLIB_TARGET_AVX2 static vector nlt(vector a, vector b) { return ge(a, b); }
+  HETLIB_TARGET_AVX2 static vector both(vector a, vector b) { return _mm256_and_si256(a, b); }
+  HETLIB_TARGET_AVX2 static vector all() { return _mm256_set1_epi32(-1); }
+  HETLIB_TARGET_AVX2 static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(v))); }
+};
+
+template <> struct avx2_lanes<float> {
+  using vector = __m256;
+  HETLIB_TARGET_AVX2 static vector load(float const * p) { return _mm256_loadu_ps(p); }
+  HETLIB_TARGET_AVX2 static vector set1(float v) { return _mm256_set1_ps(v); }
+  HETLIB_TARGET_AVX2 static vector gt(vector a, vector b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  HETLIB_TARGET_AVX2 static vector ge(vector a, vector b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+  HETLIB_TARGET_AVX2 static vector nlt(vector a, vector b) { return _mm256_cmp_ps(a, b, _CMP_NLT_UQ); }
+  HETLIB_TARGET_AVX2 static vector both(vector a, vector b) { return _mm256_and_ps(a, b); }
+  HETLIB_TARGET_AVX2 static vector all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+  HETLIB_TARGET_AVX2 static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm256_movemask_ps(v)); }
+};
+
+template <> struct avx2_lanes<double> {
+  using vector = __m256d;
+  HETLIB_TARGET_AVX2 static vector load(double const * p) { return _mm256_loadu_pd(p); }
+  HETLIB_TARGET_AVX2 static vector set1(double v) { return _mm256_set1_pd(v); }
+  HETLIB_TARGET_AVX2 static vector gt(vector a, vector b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+  HETLIB_TARGET_AVX2 static vector ge(vector a, vector b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+  HETLIB_TARGET_AVX2 static vector nlt(vector a, vector b) { return _mm256_cmp_pd(a, b, _CMP_NLT_UQ); }
+  HETLIB_TARGET_AVX2 static vector both(vector a, vector b) { return _mm256_and_pd(a, b); }
+  HETLIB_TARGET_AVX2 static vector all() { return _mm256_castsi256_pd(_mm256_set1_epi32(-1)); }
+  HETLIB_TARGET_AVX2 static std::uint32_t mask(vector v) { return static_cast<std::uint32_t>(_mm256_movemask_pd(v)); }
+};
+
+#endif
+
+// kernel element of the same representation, char goes as int8_t, int as int32_t
+template <typename T> using scan_lane_t = std::conditional_t<std::is_integral_v<T>,
+    std::conditional_t<sizeof(T) == 1, std::int8_t, std::int32_t>, T>;
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+// the shared kernel passes AVX vectors around, it's always inlined into the kernel compiled for AVX2
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// lanes of the vector matching the predicate, the bound checks are predicted branches
+template <typename Lanes, typename L, typename V = typename Lanes::vector> HETLIB_ALWAYS_INLINE
+inline std::uint32_t match_lanes(V const & x, V const & lo, V const & hi, scan_predicate<L> const & p, std::uint32_t flip) {
+  auto m = Lanes::all();
+  if(p.range.lo) {
+    m = Lanes::both(m, p.range.lo_open ? Lanes::gt(x, lo) : p.ordered ? Lanes::ge(x, lo) : Lanes::nlt(x, lo));
+  }
+  if(p.range.hi) {
+    m = Lanes::both(m, p.range.hi_open ? Lanes::gt(hi, x) : p.ordered ? Lanes::ge(hi, x) : Lanes::nlt(hi, x));
+  }
+  return Lanes::mask(m) ^ flip;
+}
+
+/**
+ * \brief Vector kernel shared by the instruction sets, inlined into the kernel compiled for the instruction set
+ * \tparam Lanes vector operations of the instruction set
+ * \param bits match bitmap to fill or nullptr to stop at the first match
+ * \return offset of the first match when bits is nullptr, offset the scalar tail starts from otherwise;
+ *         the tail offset is returned plus n if there is no match in the vector part
+ */
+template <typename Lanes, typename L> HETLIB_ALWAYS_INLINE
+inline std::size_t scan_lanes(L const * data, std::size_t n, scan_predicate<L> const & p, std::uint64_t * bits) {
+  constexpr std::size_t lanes = sizeof(typename Lanes::vector) / sizeof(L);
+  auto lo = Lanes::set1(p.range.lo ? *p.range.lo : L{});
+  auto hi = Lanes::set1(p.range.hi ? *p.range.hi : L{});
+  std::uint32_t const flip = !p.negate ? 0 : lanes == 32 ? ~std::uint32_t{0} : (std::uint32_t{1} << lanes) - 1;
+  std::size_t i = 0;
+  if(bits != nullptr) {
+    // the word of 64 elements is gathered in the register
+    for(; i + 64 <= n; i += 64) {
+      std::uint64_t word = 0;
+      for(std::size_t k = 0; k < 64; k += lanes) {
+        word |= std::uint64_t{match_lanes<Lanes>(Lanes::load(data + i + k), lo, hi, p, flip)} << k;
+      }
+      bits[i / 64] = word;
+    }
+    for(; i + lanes <= n; i += lanes) {
+      bits[i / 64] |= std::uint64_t{match_lanes<Lanes>(Lanes::load(data + i), lo, hi, p, flip)} << (i % 64);
+    }
+    return i;
+  }
+  // four vectors a step, the matching one is picked out after the step
+  for(; i + 4 * lanes <= n; i += 4 * lanes) {
+    auto m0 = match_lanes<Lanes>(Lanes::load(data + i), lo, hi, p, flip);
+    auto m1 = match_lanes<Lanes>(Lanes::load(data + i + lanes), lo, hi, p, flip);
+    auto m2 = match_lanes<Lanes>(Lanes::load(data + i + 2 * lanes), lo, hi, p, flip);
+    auto m3 = match_lanes<Lanes>(Lanes::load(data + i + 3 * lanes), lo, hi, p, flip);
+    if((m0 | m1 | m2 | m3) != 0) {
+      break;
+    }
+  }
+  for(; i + lanes <= n; i += lanes) {
+    if(auto m = match_lanes<Lanes>(Lanes::load(data + i), lo, hi, p, flip); m != 0) {
+      return i + static_cast<std::size_t>(std::countr_zero(m));
+    }
+  }
+  return n + i;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#if defined(HETLIB_SIMD_SSE2)
+template <typename L> std::size_t scan_sse2(L const * data, std::size_t n, scan_predicate<L> const & p, std::uint64_t * bits) {
+  return scan_lanes<sse2_lanes<L>>(data, n, p, bits);
+}
+#endif
+
+#if defined(HETLIB_SIMD_AVX2)
+template <typename L> HETLIB_TARGET_AVX2
+std::size_t scan_avx2(L const * data, std::size_t n, scan_predicate<L> const & p, std::uint64_t * bits) {
+  return scan_lanes<avx2_lanes<L>>(data, n, p, bits);
+}
+#endif
+
+/// \brief Instruction set of the scan kernels
+enum class scan_isa { scalar, sse2, avx2 };
+
+/// \brief Best instruction set of the running CPU, detected once through CPUID
+inline scan_isa detected_scan_isa() noexcept {
+#if defined(HETLIB_SIMD_AVX2)
+  static scan_isa const isa = __builtin_cpu_supports("avx2") ? scan_isa::avx2 : scan_isa::sse2;
+  return isa;
+#elif defined(HETLIB_SIMD_SSE2)
+  return scan_isa::sse2;
+#else
+  return scan_isa::scalar;
+#endif
+}
+
+/**
+ * \brief Runs the kernel of the instruction set over the elements
+ * \param bits zeroed bitmap of (n + 63) / 64 words to fill or nullptr to look up the first match
+ * \return offset of the first match or n if there is none, n when the bitmap is filled
+ */
+template <scan_element T>
+std::size_t scan(T const * data, std::size_t n, scan_predicate<T> const & p, std::uint64_t * bits, scan_isa isa = detected_scan_isa()) {
+  using L = scan_lane_t<T>;
+  auto lp = scan_predicate<L>{{p.range.lo ? std::optional<L>(static_cast<L>(*p.range.lo)) : std::nullopt,
+                               p.range.hi ? std::optional<L>(static_cast<L>(*p.range.hi)) : std::nullopt,
+                               p.range.lo_open, p.range.hi_open}, p.negate, p.ordered};
+  auto ldata = reinterpret_cast<L const *>(data);
+  // no vector part, the scalar kernel starts from the beginning
+  std::size_t from = bits == nullptr ? n : 0;
+  switch(isa) {
+#if defined(HETLIB_SIMD_AVX2)
+  case scan_isa::avx2:
+    from = scan_avx2(ldata, n, lp, bits);
+    break;
+#endif
+#if defined(HETLIB_SIMD_SSE2)
+  case scan_isa::sse2:
+    from = scan_sse2(ldata, n, lp, bits);
+    break;
+#endif
+  default:
+    break;
+  }
+  if(bits == nullptr) {
+    if(from < n) {
+      return from;
+    }
+    return scan_first_scalar(ldata, from - n, n, lp);
+  }
+  scan_bitmap_scalar(ldata, from, n, lp, bits);
+  return n;
+}
+
+template <typename C, typename F> inline constexpr bool is_scannable_fraction =
+    std::ranges::contiguous_range<C const> && is_scannable<std::ranges::range_value_t<C>, F>;
+
+/**
+ * \brief Looks up the first element matching the predicate by the scan kernels
+ * \return offset of the element, size of the fraction if there is none,
+ *         nullopt if the fraction or the predicate doesn't suit the kernels
+ */
+template <typename C, typename F> auto scan_first(C const & c, F const & f) -> std::optional<std::size_t> {
+  if constexpr(is_scannable_fraction<C, F>) {
+    using T = std::ranges::range_value_t<C>;
+    if(auto p = scan_recognizer<T, F>::of(f); p) {
+      return scan(std::ranges::data(c), std::ranges::size(c), *p, nullptr);
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * \brief Calls the function with the offset of every element matching the predicate, in the fraction order
+ * \details the kernels fill the bitmap of the block of elements at a time, the block bitmap lives on the stack
+ * \return number of the matching elements
+ */
+template <typename T, typename Fn> std::size_t scan_each(T const * data, std::size_t n, scan_predicate<T> const & p, Fn && fn) {
+  constexpr std::size_t block = 4096;
+  std::uint64_t bits[block / 64];
+  std::size_t count = 0;
+  for(std::size_t from = 0; from < n; from += block) {
+    auto size = std::min(block, n - from);
+    std::fill_n(bits, (size + 63) / 64, 0);
+    scan(data + from, size, p, bits);
+    for(std::size_t w = 0; w < (size + 63) / 64; ++w) {
+      for(auto word = bits[w]; word != 0; word &= word - 1) {
+        fn(from + w * 64 + static_cast<std::size_t>(std::countr_zero(word)));
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+/// \brief Counts the elements matching the predicate by the population count of the block bitmaps
+template <typename T> std::size_t scan_count(T const * data, std::size_t n, scan_predicate<T> const & p) {
+  constexpr std::size_t block = 4096;
+  std::uint64_t bits[block / 64];
+  std::size_t count = 0;
+  for(std::size_t from = 0; from < n; from += block) {
+    auto size = std::min(block, n - from);
+    std::fill_n(bits, (size + 63) / 64, 0);
+    scan(data + from, size, p, bits);
+    for(std::size_t w = 0; w < (size + 63) / 64; ++w) {
+      count += static_cast<std::size_t>(std::popcount(bits[w]));
+    }
+  }
+  return count;
+}
+
+/**
+ * \brief Appends the offsets of the elements of [first, last) matching the predicate, in the fraction order
+ * \note the scan kernels evaluate the predicate they recognize, the predicate is called per element otherwise
+ */
+template <typename C, typename F>
+void match_offsets(C const & c, std::size_t first, std::size_t last, F const & f, std::vector<std::size_t> & offsets) {
+  if constexpr(is_scannable_fraction<C, F>) {
+    using T = std::ranges::range_value_t<C>;
+    if(auto p = scan_recognizer<T, F>::of(f); p) {
+      scan_each(std::ranges::data(c) + first, last - first, *p, [&offsets, first](std::size_t i) { offsets.push_back(first + i); });
+      return;
+    }
+  }
+  auto it = std::next(std::begin(c), static_cast<std::ptrdiff_t>(first));
+  for(auto i = first; i < last; ++i, ++it) {
+    if(std::invoke(f, *it)) {
+      offsets.push_back(i);
+    }
+  }
+}
+
+/// \brief Counts the elements of [first, last) matching the predicate, see match_offsets()
+template <typename C, typename F> std::size_t count_matches(C const & c, std::size_t first, std::size_t last, F const & f) {
+  if constexpr(is_scannable_fraction<C, F>) {
+    using T = std::ranges::range_value_t<C>;
+    if(auto p = scan_recognizer<T, F>::of(f); p) {
+      return scan_count(std::ranges::data(c) + first, last - first, *p);
+    }
+  }
+  auto it = std::next(std::begin(c), static_cast<std::ptrdiff_t>(first));
+  return static_cast<std::size_t>(std::count_if(it, std::next(it, static_cast<std::ptrdiff_t>(last - first)), [&f](auto const & e) {
+    return static_cast<bool>(std::invoke(f, e));
+  }));
+}
+
+/**
+ * \brief Builds the bitmap of the elements matching the predicate, bit i % 64 of the word i / 64 stands for the element i
+ * \param bits zeroed bitmap of (size + 63) / 64 words
+ * \note falls back to the predicate call per element if the fraction or the predicate doesn't suit the kernels
+ */
+template <typename C, typename F> void scan_bitmap(C const & c, F const & f, std::uint64_t * bits) {
+  if constexpr(is_scannable_fraction<C, F>) {
+    using T = std::ranges::range_value_t<C>;
+    if(auto p = scan_recognizer<T, F>::of(f); p) {
+      scan(std::ranges::data(c), std::ranges::size(c), *p, bits);
+      return;
+    }
+  }
+  std::size_t i = 0;
+  for(auto && e : c) {
+    bits[i / 64] |= std::uint64_t{static_cast<bool>(std::invoke(f, e))} << (i % 64);
+    ++i;
+  }
+}
+
+} // namespace het::details
+
+#endif //HETLIB_SIMD_SCAN_H
@@ -0,0 +1,353 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_SLOT_MAP_H
+#define HETLIB_SLOT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace het {
+
+/// \brief Stable key of the slot_map element, the generation tells apart elements reusing the same slot
+struct slot_key {
+  std::uint32_t index;
+  std::uint32_t generation;
+
+  friend bool operator==(slot_key const &, slot_key const &) = default;
+};
+
+/**
+ * \brief Dense vector of elements addressed by stable generational keys
+ * \tparam T element type
+ * \tparam Allocator allocator of the elements, rebound for the slot tables
+ * \details Elements are kept contiguous, so iteration is a plain vector sweep. Keys survive insertions
+ * and erasures of other elements, a key of the erased element never resolves to another element:
+ * the slot is reused with the next generation, the slot whose 32-bit generations are used up is retired.
+ * Erasure moves the last element into the hole, so it's O(1) and the dense order is not preserved.
+ * \note positional insert and emplace keep the sequence interface of the inner container, the position is
+ * ignored and the element is always appended
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class slot_map {
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  // live slot keeps the dense index of its element, free slot keeps the next free slot
+  struct slot {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  using values_type = std::vector<T, Allocator>;
+  using slot_of_type = std::vector<std::uint32_t, typename alloc_traits::template rebind_alloc<std::uint32_t>>;
+  using slots_type = std::vector<slot, typename alloc_traits::template rebind_alloc<slot>>;
+
+  static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+  // generation of the slot out of use, no key of it is handed out so none resolves
+  static constexpr std::uint32_t retired = std::numeric_limits<std::uint32_t>::max();
+
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = T const &;
+  using iterator = typename values_type::iterator;
+  using const_iterator = typename values_type::const_iterator;
+  using key_type = slot_key;
+
+  /// \brief Erasure does not preserve the order of elements
+  static constexpr bool preserves_order = false;
+
+  slot_map() = default;
+
+  explicit slot_map(Allocator const & alloc) : _values(alloc), _slot_of(alloc), _slots(alloc) {}
+
+  slot_map(slot_map const &) = default;
+  slot_map & operator=(slot_map const &) = default;
+
+  // the moved-from map is empty and has no free slots, so it stays usable
+  slot_map(slot_map && other) noexcept
+    : _values(std::move(other._values)), _slot_of(std::move(other._slot_of)), _slots(std::move(other._slots)),
+      _free(std::exchange(other._free, npos)) {}
+
+  slot_map & operator=(slot_map && other) noexcept(std::is_nothrow_move_assignable_v<values_type> &&
+                                                    std::is_nothrow_move_assignable_v<slot_of_type> &&
+                                                    std::is_nothrow_move_assignable_v<slots_type>) {
+    if(this != &other) {
+      _values = std::move(other._values);
+      _slot_of = std::move(other._slot_of);
+      _slots = std::move(other._slots);
+      _free = std::exchange(other._free, npos);
+      // the vectors moved element-wise between unequal allocators aren't guaranteed to be empty
+      other._values.clear();
+      other._slot_of.clear();
+      other._slots.clear();
+    }
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept { return _values.get_allocator(); }
+
+  [[nodiscard]] iterator begin() noexcept { return _values.begin(); }
+  [[nodiscard]] const_iterator begin() const noexcept { return _values.begin(); }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return _values.cbegin(); }
+  [[nodiscard]] iterator end() noexcept { return _values.end(); }
+  [[nodiscard]] const_iterator end() const noexcept { return _values.end(); }
+  [[nodiscard]] const_iterator cend() const noexcept { return _values.cend(); }
+
+  [[nodiscard]] bool empty() const noexcept { return _values.empty(); }
+  [[nodiscard]] size_type size() const noexcept { return _values.size(); }
+  [[nodiscard]] size_type capacity() const noexcept { return _values.capacity(); }
+
+  [[nodiscard]] T * data() noexcept { return _values.data(); }
+  [[nodiscard]] T const * data() const noexcept { return _values.data(); }
+
+  [[nodiscard]] reference operator[](size_type pos) { return _values[pos]; }
+  [[nodiscard]] const_reference operator[](size_type pos) const { return _values[pos]; }
+  [[nodiscard]] reference at(size_type pos) { return _values.at(pos); }
+  [[nodiscard]] const_reference at(size_type pos) const { return _values.at(pos); }
+
+  [[nodiscard]] reference front() { return _values.front(); }
+  [[nodiscard]] const_reference front() const { return _values.front(); }
+  [[nodiscard]] reference back() { return _values.back(); }
+  [[nodiscard]] const_reference back() const { return _values.back(); }
+
+  /// \brief Unchecked access to the element by its key
+  [[nodiscard]] reference operator[](key_type key) { return _values[_slots[key.index].index]; }
+  [[nodiscard]] const_reference operator[](key_type key) const { return _values[_slots[key.index].index]; }
+
+  /// \brief Checked access to the element by its key, throws std::out_of_range if the element is erased
+  [[nodiscard]] reference at(key_type key) {
+    if(!contains(key)) {
+      throw std::out_of_range("slot_map::at");
+    }
+    return (*this)[key];
+  }
+
+  [[nodiscard]] const_reference at(key_type key) const {
+    if(!contains(key)) {
+      throw std::out_of_range("slot_map::at");
+    }
+    return (*this)[key];
+  }
+
+  [[nodiscard]] bool contains(key_type key) const noexcept {
+    return key.index < _slots.size() && _slots[key.index].generation == key.generation;
+  }
+
+  /// \brief Returns iterator to the element of the key or end() if the element is erased
+  [[nodiscard]] iterator find(key_type key) noexcept {
+    return contains(key) ? begin() + _slots[key.index].index : end();
+  }
+
+  [[nodiscard]] const_iterator find(key_type key) const noexcept {
+    return contains(key) ? begin() + _slots[key.index].index : end();
+  }
+
+  /// \brief Returns the key of the element at the position
+  [[nodiscard]] key_type key_of(const_iterator pos) const noexcept {
+    auto s = _slot_of[static_cast<size_type>(pos - cbegin())];
+    return {s, _slots[s].generation};
+  }
+
+  /// \brief Returns the key of the element, which must be kept by this slot map
+  [[nodiscard]] key_type key_of(const_reference value) const noexcept {
+    return key_of(cbegin() + (std::addressof(value) - data()));
+  }
+
+  void reserve(size_type capacity) {
+    _values.reserve(capacity);
+    _slot_of.reserve(capacity);
+    _slots.reserve(capacity);
+  }
+
+  /// \brief Releases unused capacity, the slots of erased elements stay as they keep the generations of their keys
+  void shrink_to_fit() {
+    _values.shrink_to_fit();
+    _slot_of.shrink_to_fit();
+    _slots.shrink_to_fit();
+  }
+
+  /// \brief Bytes of the slot tables, elements excluded
+  [[nodiscard]] size_type index_bytes() const noexcept {
+    return _slot_of.capacity() * sizeof(std::uint32_t) + _slots.capacity() * sizeof(slot);
+  }
+
+  /// \brief Erases all the elements, their keys are invalidated while slots are kept for reuse
+  void clear() noexcept {
+    for(auto s : _slot_of) {
+      release_slot(s);
+    }
+    _values.clear();
+    _slot_of.clear();
+  }
+
+  key_type insert(T const & value) {
+    return emplace_key(value);
+  }
+
+  key_type insert(T && value) {
+    return emplace_key(std::move(value));
+  }
+
+  template <typename... Args> key_type emplace_key(Args &&... args) {
+    return key_of(std::prev(append(std::forward<Args>(args)...)));
+  }
+
+  iterator insert(const_iterator, T const & value) {
+    return std::prev(append(value));
+  }
+
+  iterator insert(const_iterator, T && value) {
+    return std::prev(append(std::move(value)));
+  }
+
+  template <typename... Args> iterator emplace(const_iterator, Args &&... args) {
+    return std::prev(append(std::forward<Args>(args)...));
+  }
+
+  template <typename... Args> reference emplace_back(Args &&... args) {
+    return *std::prev(append(std::forward<Args>(args)...));
+  }
+
+  void push_back(T const & value) {
+    append(value);
+  }
+
+  void push_back(T && value) {
+    append(std::move(value));
+  }
+
+  /// \brief Erases the element of the key, returns false if it's already erased
+  bool erase(key_type key) {
+    if(!contains(key)) {
+      return false;
+    }
+    erase_at(_slots[key.index].index);
+    return true;
+  }
+
+  /// \brief Erases the element moving the last one into its place, returns iterator to the moved element
+  iterator erase(const_iterator pos) {
+    auto idx = static_cast<size_type>(pos - cbegin());
+    erase_at(idx);
+    return begin() + static_cast<difference_type>(idx);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto f = static_cast<size_type>(first - cbegin());
+    for(auto idx = static_cast<size_type>(last - cbegin()); idx > f; --idx) {
+      erase_at(idx - 1);
+    }
+    return begin() + static_cast<difference_type>(f);
+  }
+
+  /**
+   * \brief Erases all the elements satisfying the predicate
+   * \param f predicate, called once per element
+   * \return number of erased elements
+   */
+  template <typename F> size_type erase_if(F && f) {
+    size_type erased = 0;
+    for(size_type idx = 0; idx < _values.size();) {
+      if(std::invoke(f, std::as_const(_values[idx]))) {
+        erase_at(idx);
+        ++erased;
+      } else {
+        ++idx;
+      }
+    }
+    return erased;
+  }
+
+  void swap(slot_map & other) noexcept {
+    _values.swap(other._values);
+    _slot_of.swap(other._slot_of);
+    _slots.swap(other._slots);
+    std::swap(_free, other._free);
+  }
+
+  friend void swap(slot_map & lhs, slot_map & rhs) noexcept {
+    lhs.swap(rhs);
+  }
+
+  /// \brief Compares elements in their dense order
+  friend bool operator==(slot_map const & lhs, slot_map const & rhs) {
+    return lhs._values == rhs._values;
+  }
+
+private:
+  // appends the element taking a free slot or a new one, the tables are grown first so the element is the only throwing step
+  template <typename... Args> iterator append(Args &&... args) {
+    // every element holds a slot, retired slots are counted as well
+    if(_free == npos && _slots.size() >= npos - 1) {
+      throw std::length_error("slot_map is too large");
+    }
+    grow(_slot_of);
+    if(_free == npos) {
+      grow(_slots);
+    }
+    _values.emplace_back(std::forward<Args>(args)...);
+    std::uint32_t s = _free;
+    if(s == npos) {
+      s = static_cast<std::uint32_t>(_slots.size());
+      _slots.push_back({0, 0});
+    } else {
+      _free = _slots[s].index;
+    }
+    _slots[s].index = static_cast<std::uint32_t>(_values.size() - 1);
+    _slot_of.push_back(s);
+    return _values.end();
+  }
+
+  // makes room for one more element keeping the geometric growth
+  template <typename V> static void grow(V & v) {
+    if(v.size() == v.capacity()) {
+      v.reserve(std::max<size_type>(v.capacity() * 2, 8));
+    }
+  }
+
+  void erase_at(size_type idx) {
+    auto s = _slot_of[idx];
+    if(auto last = _values.size() - 1; idx != last) {
+      _values[idx] = std::move(_values[last]);
+      _slot_of[idx] = _slot_of[last];
+      _slots[_slot_of[idx]].index = static_cast<std::uint32_t>(idx);
+    }
+    _values.pop_back();
+    _slot_of.pop_back();
+    release_slot(s);
+  }
+
+  // the generation bump invalidates keys of the slot, the slot whose generations are used up is retired rather than freed
+  void release_slot(std::uint32_t s) noexcept {
+    if(++_slots[s].generation == retired) {
+      return;
+    }
+    _slots[s].index = _free;
+    _free = s;
+  }
+
+  values_type _values;
+  // slot of every element, in the dense order
+  slot_of_type _slot_of;
+  slots_type _slots;
+  // head of the free slots list
+  std::uint32_t _free = npos;
+};
+
+} // namespace het
+
+#endif //HETLIB_SLOT_MAP_H
@@ -0,0 +1,379 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_SMALL_VECTOR_H
+#define HETLIB_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace het {
+
+/**
+ * \brief Vector which keeps up to N elements inline and moves to the heap beyond that
+ * \tparam T element type
+ * \tparam N number of elements stored inline
+ * \details Iterators are plain pointers, so the fraction accessors and algorithms relying on
+ * contiguous random access iterators work the same way as with std::vector.
+ * \attention unlike std::vector, moving a small_vector with inline elements moves them one by one,
+ * so iterators and pointers to inline elements are invalidated by the move
+ */
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>> requires (N > 0)
+class small_vector {
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = T const &;
+  using pointer = T *;
+  using const_pointer = T const *;
+  using iterator = T *;
+  using const_iterator = T const *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static constexpr size_type inline_capacity = N;
+
+  small_vector() noexcept(std::is_nothrow_default_constructible_v<Allocator>) = default;
+
+  explicit small_vector(size_type count) {
+    fill_or_release([&] { resize(count); });
+  }
+
+  small_vector(size_type count, T const & value) {
+    fill_or_release([&] { assign(count, value); });
+  }
+
+  small_vector(std::initializer_list<T> init) {
+    fill_or_release([&] { assign(init.begin(), init.end()); });
+  }
+
+  template <std::input_iterator It> small_vector(It first, It last) {
+    fill_or_release([&] { assign(first, last); });
+  }
+
+  small_vector(small_vector const & other) {
+    fill_or_release([&] { assign(other.begin(), other.end()); });
+  }
+
+  small_vector(small_vector && other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    take(std::move(other));
+  }
+
+  ~small_vector() {
+    clear();
+    deallocate();
+  }
+
+  small_vector & operator=(small_vector const & other) {
+    if(&other != this) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  small_vector & operator=(small_vector && other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if(&other != this) {
+      clear();
+      deallocate();
+      take(std::move(other));
+    }
+    return *this;
+  }
+
+  small_vector & operator=(std::initializer_list<T> init) {
+    assign(init.begin(), init.end());
+    return *this;
+  }
+
+  void assign(size_type count, T const & value) {
+    clear();
+    reserve(count);
+    std::uninitialized_fill_n(_data, count, value);
+    _size = count;
+  }
+
+  template <std::input_iterator It> void assign(It first, It last) {
+    clear();
+    if constexpr(std::forward_iterator<It>) {
+      reserve(static_cast<size_type>(std::distance(first, last)));
+    }
+    for(; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept { return _alloc; }
+
+  [[nodiscard]] iterator begin() noexcept { return _data; }
+  [[nodiscard]] const_iterator begin() const noexcept { return _data; }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return _data; }
+  [[nodiscard]] iterator end() noexcept { return _data + _size; }
+  [[nodiscard]] const_iterator end() const noexcept { return _data + _size; }
+  [[nodiscard]] const_iterator cend() const noexcept { return _data + _size; }
+  [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+  [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  [[nodiscard]] reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  [[nodiscard]] const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+  [[nodiscard]] const_reverse_iterator crend() const noexcept { return rend(); }
+
+  [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+  [[nodiscard]] size_type size() const noexcept { return _size; }
+  [[nodiscard]] size_type capacity() const noexcept { return _capacity; }
+  [[nodiscard]] size_type max_size() const noexcept { return alloc_traits::max_size(_alloc); }
+  /// \brief Tells whether the elements are kept inline, i.e. no heap allocation is owned
+  [[nodiscard]] bool is_inline() const noexcept { return _data == inline_data(); }
+
+  [[nodiscard]] T * data() noexcept { return _data; }
+  [[nodiscard]] T const * data() const noexcept { return _data; }
+
+  [[nodiscard]] reference operator[](size_type pos) { return _data[pos]; }
+  [[nodiscard]] const_reference operator[](size_type pos) const { return _data[pos]; }
+
+  [[nodiscard]] reference at(size_type pos) {
+    if(pos >= _size) {
+      throw std::out_of_range("small_vector::at");
+    }
+    return _data[pos];
+  }
+
+  [[nodiscard]] const_reference at(size_type pos) const {
+    if(pos >= _size) {
+      throw std::out_of_range("small_vector::at");
+    }
+    return _data[pos];
+  }
+
+  [[nodiscard]] reference front() { return _data[0]; }
+  [[nodiscard]] const_reference front() const { return _data[0]; }
+  [[nodiscard]] reference back() { return _data[_size - 1]; }
+  [[nodiscard]] const_reference back() const { return _data[_size - 1]; }
+
+  void reserve(size_type capacity) {
+    if(capacity > _capacity) {
+      relocate(capacity);
+    }
+  }
+
+  /// \brief Moves the elements back inline if they fit, or into the exactly sized heap buffer
+  void shrink_to_fit() {
+    if(!is_inline() && _size < _capacity) {
+      relocate(_size);
+    }
+  }
+
+  void clear() noexcept {
+    std::destroy_n(_data, _size);
+    _size = 0;
+  }
+
+  template <typename... Args> reference emplace_back(Args &&... args) {
+    if(_size == _capacity) {
+      return grow_emplace_back(std::forward<Args>(args)...);
+    }
+    auto p = std::construct_at(_data + _size, std::forward<Args>(args)...);
+    ++_size;
+    return *p;
+  }
+
+  void push_back(T const & value) {
+    emplace_back(value);
+  }
+
+  void push_back(T && value) {
+    emplace_back(std::move(value));
+  }
+
+  void pop_back() {
+    std::destroy_at(_data + --_size);
+  }
+
+  template <typename... Args> iterator emplace(const_iterator pos, Args &&... args) {
+    auto idx = static_cast<size_type>(pos - cbegin());
+    if(idx == _size) {
+      emplace_back(std::forward<Args>(args)...);
+      return _data + idx;
+    }
+    // the value is built beforehand since the arguments may refer to the elements being shifted
+    T value(std::forward<Args>(args)...);
+    emplace_back(std::move(back()));
+    std::move_backward(_data + idx, _data + _size - 2, _data + _size - 1);
+    _data[idx] = std::move(value);
+    return _data + idx;
+  }
+
+  iterator insert(const_iterator pos, T const & value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T && value) {
+    return emplace(pos, std::move(value));
+  }
+
+  template <std::input_iterator It> iterator insert(const_iterator pos, It first, It last) {
+    auto idx = static_cast<size_type>(pos - cbegin());
+    auto old_size = _size;
+    for(; first != last; ++first) {
+      emplace_back(*first);
+    }
+    std::rotate(_data + idx, _data + old_size, _data + _size);
+    return _data + idx;
+  }
+
+  iterator erase(const_iterator pos) {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto f = _data + (first - cbegin());
+    auto l = _data + (last - cbegin());
+    if(f != l) {
+      auto new_end = std::move(l, end(), f);
+      std::destroy(new_end, end());
+      _size -= static_cast<size_type>(l - f);
+    }
+    return f;
+  }
+
+  void resize(size_type count) {
+    resize_with(count, [](T * p) { std::construct_at(p); });
+  }
+
+  void resize(size_type count, T const & value) {
+    resize_with(count, [&value](T * p) { std::construct_at(p, value); });
+  }
+
+  void swap(small_vector & other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    small_vector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend void swap(small_vector & lhs, small_vector & rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    lhs.swap(rhs);
+  }
+
+  friend bool operator==(small_vector const & lhs, small_vector const & rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+private:
+  [[nodiscard]] T * inline_data() noexcept { return reinterpret_cast<T *>(_inline); }
+  [[nodiscard]] T const * inline_data() const noexcept { return reinterpret_cast<T const *>(_inline); }
+
+  // steals the heap buffer or moves the inline elements one by one
+  void take(small_vector && other) {
+    if(other.is_inline()) {
+      std::uninitialized_move_n(other._data, other._size, inline_data());
+      _size = other._size;
+      other.clear();
+    } else {
+      _data = std::exchange(other._data, other.inline_data());
+      _size = std::exchange(other._size, 0);
+      _capacity = std::exchange(other._capacity, N);
+    }
+  }
+
+  // moves the elements into the inline storage if the capacity fits, or into the new heap buffer
+  void relocate(size_type capacity) {
+    auto data = capacity <= N ? inline_data() : alloc_traits::allocate(_alloc, capacity);
+    if(data == _data) {
+      return;
+    }
+    try {
+      std::uninitialized_move_n(_data, _size, data);
+    } catch(...) {
+      if(data != inline_data()) {
+        alloc_traits::deallocate(_alloc, data, capacity);
+      }
+      throw;
+    }
+    std::destroy_n(_data, _size);
+    deallocate();
+    _data = data;
+    _capacity = std::max(capacity, N);
+  }
+
+  // builds the new element in the new buffer first since the arguments may refer to the old one
+  template <typename... Args> reference grow_emplace_back(Args &&... args) {
+    auto capacity = std::max<size_type>(_capacity * 2, 1);
+    auto data = alloc_traits::allocate(_alloc, capacity);
+    try {
+      std::construct_at(data + _size, std::forward<Args>(args)...);
+    } catch(...) {
+      alloc_traits::deallocate(_alloc, data, capacity);
+      throw;
+    }
+    try {
+      std::uninitialized_move_n(_data, _size, data);
+    } catch(...) {
+      std::destroy_at(data + _size);
+      alloc_traits::deallocate(_alloc, data, capacity);
+      throw;
+    }
+    std::destroy_n(_data, _size);
+    deallocate();
+    _data = data;
+    _capacity = capacity;
+    return _data[_size++];
+  }
+
+  // the size follows every constructed element, so the ones built before a throwing construct are kept and destroyed with the vector
+  template <typename F> void resize_with(size_type count, F && construct) {
+    if(count < _size) {
+      std::destroy(_data + count, end());
+      _size = count;
+    } else {
+      reserve(count);
+      for(; _size != count; ++_size) {
+        construct(_data + _size);
+      }
+    }
+  }
+
+  // fills the vector being constructed, its destructor doesn't run if the constructor throws
+  template <typename F> void fill_or_release(F && fill) {
+    try {
+      fill();
+    } catch(...) {
+      clear();
+      deallocate();
+      throw;
+    }
+  }
+
+  void deallocate() noexcept {
+    if(!is_inline()) {
+      alloc_traits::deallocate(_alloc, std::exchange(_data, inline_data()), _capacity);
+      _capacity = N;
+    }
+  }
+
+  [[no_unique_address]] Allocator _alloc{};
+  T * _data = inline_data();
+  size_type _size = 0;
+  size_type _capacity = N;
+  alignas(T) std::byte _inline[N * sizeof(T)];
+};
+
+/// \brief Binds the inline capacity, so small_vector fits template template parameters taking the element type only
+template <std::size_t N> struct small_vector_n {
+  template <typename T> using type = small_vector<T, N>;
+};
+
+} // namespace het
+
+#endif //HETLIB_SMALL_VECTOR_H
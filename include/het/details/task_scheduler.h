@@ -0,0 +1,241 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_TASK_SCHEDULER_H
+#define HETLIB_TASK_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace het {
+
+/**
+ * \brief Work-stealing thread pool running the parallel algorithms of the containers
+ * \details every worker owns a deque of tasks, it pushes and pops the tasks at the back and the idle workers steal
+ * from the front of the others' deques; threads outside the pool submit to the injection queue. parallel_for()
+ * is fork/join: the range is halved until the grain, the halves are pushed for stealing and the thread waiting
+ * for the range runs the pending tasks meanwhile, so nested parallel_for() calls don't block the workers.
+ */
+class task_scheduler {
+public:
+  /// \brief Starts the workers, the thread calling parallel_for() takes part in it, so 0 workers run it inline
+  explicit task_scheduler(std::size_t workers = default_workers()) : _queues(workers + 1) {
+    _threads.reserve(workers);
+    try {
+      for(std::size_t i = 0; i < workers; ++i) {
+        _threads.emplace_back([this, i] { work(i); });
+      }
+    } catch(...) {
+      stop();
+      throw;
+    }
+  }
+
+  task_scheduler(task_scheduler const &) = delete;
+  task_scheduler & operator=(task_scheduler const &) = delete;
+
+  ~task_scheduler() {
+    stop();
+  }
+
+  /// \brief Process-wide scheduler of hardware_concurrency() - 1 workers started on the first use
+  [[nodiscard]] static task_scheduler & shared() {
+    static task_scheduler scheduler;
+    return scheduler;
+  }
+
+  [[nodiscard]] static std::size_t default_workers() noexcept {
+    return std::max<std::size_t>(std::thread::hardware_concurrency(), 1) - 1;
+  }
+
+  [[nodiscard]] std::size_t workers() const noexcept { return _threads.size(); }
+  /// \brief Number of the threads running parallel_for(), the workers and the calling thread
+  [[nodiscard]] std::size_t concurrency() const noexcept { return _threads.size() + 1; }
+
+  /**
+   * \brief Runs the body over the chunks of [first, last) of at most grain indices and waits for all of them
+   * \param body invocable with the bounds of the chunk, body(begin, end), concurrently
+   * \throw rethrows the first exception thrown by the body or by queuing the chunks (std::bad_alloc),
+   *        the chunks not started yet are skipped
+   */
+  template <typename F> void parallel_for(std::size_t first, std::size_t last, std::size_t grain, F && body) {
+    if(first >= last) {
+      return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    if(_threads.empty() || last - first <= grain) {
+      while(first < last) {
+        auto end = first + std::min(grain, last - first);
+        body(first, end);
+        first = end;
+      }
+      return;
+    }
+    job j;
+    j.run = [](void const * b, std::size_t begin, std::size_t end) { (*static_cast<std::remove_reference_t<F> const *>(b))(begin, end); };
+    j.body = std::addressof(body);
+    j.grain = grain;
+    j.remaining.store(last - first, std::memory_order_relaxed);
+    execute(task{&j, first, last});
+    while(j.remaining.load(std::memory_order_acquire) != 0) {
+      if(auto t = take(); t) {
+        execute(*t);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    if(j.error) {
+      std::rethrow_exception(j.error);
+    }
+  }
+
+private:
+  // shared state of the parallel_for() call
+  struct job {
+    void (*run)(void const *, std::size_t, std::size_t);
+    void const * body;
+    std::size_t grain;
+    std::atomic<std::size_t> remaining{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+  };
+
+  struct task {
+    job * owner;
+    std::size_t first;
+    std::size_t last;
+  };
+
+  struct alignas(64) queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  // scheduler and queue of the current worker thread
+  static inline thread_local task_scheduler const * _current_scheduler = nullptr;
+  static inline thread_local std::size_t _current_index = 0;
+
+  // queue of the current thread, the injection queue (the last one) for the threads outside the pool
+  [[nodiscard]] std::size_t self() const noexcept {
+    return _current_scheduler == this ? _current_index : _queues.size() - 1;
+  }
+
+  void push(task t) {
+    {
+      auto & q = _queues[self()];
+      std::lock_guard lock(q.mutex);
+      q.tasks.push_back(t);
+    }
+    _queued.fetch_add(1);
+    if(_sleepers.load() > 0) {
+      // the sleeper either sees the queued task or is waiting already
+      { std::lock_guard lock(_sleep_mutex); }
+      _wake.notify_one();
+    }
+  }
+
+  auto take() -> std::optional<task> {
+    auto own = self();
+    {
+      auto & q = _queues[own];
+      std::lock_guard lock(q.mutex);
+      if(!q.tasks.empty()) {
+        auto t = q.tasks.back();
+        q.tasks.pop_back();
+        _queued.fetch_sub(1);
+        return t;
+      }
+    }
+    for(std::size_t k = 1; k < _queues.size(); ++k) {
+      auto & q = _queues[(own + k) % _queues.size()];
+      std::lock_guard lock(q.mutex);
+      if(!q.tasks.empty()) {
+        auto t = q.tasks.front();
+        q.tasks.pop_front();
+        _queued.fetch_sub(1);
+        return t;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void execute(task t) {
+    auto & j = *t.owner;
+    // the rest of the failed job is skipped without splitting
+    while(t.last - t.first > j.grain && !j.failed.load(std::memory_order_relaxed)) {
+      auto mid = t.first + (t.last - t.first) / 2;
+      try {
+        push(task{&j, mid, t.last});
+      } catch(...) {
+        // the half which isn't queued stays in this task, so it's drained below along with the rest of the job
+        if(!j.failed.exchange(true)) {
+          j.error = std::current_exception();
+        }
+        break;
+      }
+      t.last = mid;
+    }
+    if(!j.failed.load(std::memory_order_relaxed)) {
+      try {
+        j.run(j.body, t.first, t.last);
+      } catch(...) {
+        if(!j.failed.exchange(true)) {
+          j.error = std::current_exception();
+        }
+      }
+    }
+    j.remaining.fetch_sub(t.last - t.first, std::memory_order_acq_rel);
+  }
+
+  void stop() noexcept {
+    {
+      std::lock_guard lock(_sleep_mutex);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for(auto & t : _threads) {
+      t.join();
+    }
+  }
+
+  void work(std::size_t index) {
+    _current_scheduler = this;
+    _current_index = index;
+    while(true) {
+      if(auto t = take(); t) {
+        execute(*t);
+        continue;
+      }
+      std::unique_lock lock(_sleep_mutex);
+      _sleepers.fetch_add(1);
+      _wake.wait(lock, [this] { return _stop || _queued.load() > 0; });
+      _sleepers.fetch_sub(1);
+      if(_stop && _queued.load() == 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<queue> _queues;
+  std::vector<std::thread> _threads;
+  std::atomic<std::size_t> _queued{0};
+  std::atomic<std::size_t> _sleepers{0};
+  std::mutex _sleep_mutex;
+  std::condition_variable _wake;
+  bool _stop = false;
+};
+
+} // namespace het
+
+#endif //HETLIB_TASK_SCHEDULER_H
@@ -0,0 +1,35 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_TYPE_INDEX_H
+#define HETLIB_TYPE_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace het::details {
+
+/**
+ * \brief Assigns dense zero-based ids to types on first use within the Family
+ * \tparam Family owner of the id space, ids of different families do not collide
+ * \attention ids are stable for the process lifetime, but their order depends on the first use order
+ */
+template <typename Family> class type_index {
+public:
+  template <typename T> [[nodiscard]] static std::size_t of() noexcept {
+    static std::size_t const id = _next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+  }
+
+  [[nodiscard]] static std::size_t count() noexcept {
+    return _next.load(std::memory_order_relaxed);
+  }
+
+private:
+  static inline std::atomic<std::size_t> _next{0};
+};
+
+} // namespace het::details
+
+#endif //HETLIB_TYPE_INDEX_H
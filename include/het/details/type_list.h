@@ -0,0 +1,41 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_TYPE_LIST_H
+#define HETLIB_TYPE_LIST_H
+
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace het::details {
+
+template <typename T, typename... Ts> constexpr bool is_one_of = (std::same_as<T, Ts> || ...);
+
+template <typename... Ts> constexpr bool is_unique = true;
+template <typename T, typename... Ts> constexpr bool is_unique<T, Ts...> = !is_one_of<T, Ts...> && is_unique<Ts...>;
+
+// maps every type of the pack to the count of its elements, e.g. for per-type size arguments
+template <typename> using count_for = std::size_t;
+
+template <typename T, typename... Ts> consteval std::size_t index_of() {
+  std::size_t i = 0;
+  ((std::same_as<T, Ts> ? false : (++i, true)) && ...);
+  return i;
+}
+
+// number of occurrences of the I-th type among the preceding types of the list
+template <std::size_t I, typename... Ts> consteval std::size_t occurrence_of() {
+  using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+  std::size_t n = 0;
+  [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+    ((n += std::same_as<T, std::tuple_element_t<Is, std::tuple<Ts...>>> ? 1 : 0), ...);
+  }(std::make_index_sequence<I>{});
+  return n;
+}
+
+} // namespace het::details
+
+#endif //HETLIB_TYPE_LIST_H
@@ -8,5 +8,7 @@
 #include "het_value.h"
 #include "het_keyvalue.h"
 #include "het_container.h"
+#include "het_static_container.h"
+#include "het_packed_container.h"
 
 #endif // HETLIB_HET_H
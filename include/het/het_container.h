@@ -9,15 +9,37 @@
 #include "details/expected.h"
 #include "details/error.h"
 #include "details/typesafe.h"
+#include "details/type_index.h"
+#include "details/type_list.h"
+#include "details/sharded_map.h"
+#include "details/small_vector.h"
+#include "details/slot_map.h"
+#include "details/memory_usage.h"
+#include "details/fraction_index.h"
+#include "details/query_expression.h"
+#include "details/simd_scan.h"
+#include "details/parallel.h"
+#include "details/joined_view.h"
+#include "details/generator.h"
+#include "details/join.h"
 
 #include <deque>
 #include <vector>
+#include <ranges>
 #include <memory>
+#include <memory_resource>
 
 #include <tuple>
 #include <functional>
 #include <unordered_map>
 #include <limits>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <exception>
+#include <mutex>
+#include <atomic>
 
 namespace het {
 
@@ -26,22 +48,46 @@ using tl::make_unexpected;
 
 using namespace metaf::util;
 
-namespace {
+/**
+ * \brief Fraction resolved once, element access through it skips the fraction lookup
+ * \tparam C type of the fraction, const qualified for the read-only access
+ * \attention the handle is valid until the fraction is released, i.e. the container is cleared, moved from
+ *            or destroyed, or the fraction is erased to empty; iterators are invalidated like the fraction ones
+ */
+template <typename C> class fraction_handle {
+public:
+  using value_type = typename std::remove_const_t<C>::value_type;
+  using size_type = std::size_t;
+  using iterator = decltype(std::begin(std::declval<C &>()));
+  using reference = std::iter_reference_t<iterator>;
 
-template<typename T> struct type_offset {
-  static std::size_t offset;
+  explicit fraction_handle(C & fraction) noexcept : _fraction(&fraction) {}
 
-  explicit type_offset() noexcept { type_offset::offset++; }
+  /// \brief Unchecked access to the element at the index
+  [[nodiscard]] reference operator[](size_type index) const {
+    return (*_fraction)[index];
+  }
 
-  static constexpr void reset() noexcept { type_offset::offset = 0; }
-};
+  /// \brief Checked access to the element at the index, throws std::out_of_range
+  [[nodiscard]] reference at(size_type index) const {
+    return _fraction->at(index);
+  }
 
-template<typename T> std::size_t type_offset<T>::offset = 0;
+  [[nodiscard]] size_type size() const noexcept { return std::size(*_fraction); }
+  [[nodiscard]] bool empty() const noexcept { return std::empty(*_fraction); }
+  [[nodiscard]] iterator begin() const noexcept { return std::begin(*_fraction); }
+  [[nodiscard]] iterator end() const noexcept { return std::end(*_fraction); }
+  [[nodiscard]] C & fraction() const noexcept { return *_fraction; }
 
-} // namespace anonymous
+private:
+  C * _fraction;
+};
 
-template <template <typename...> class InnerC, template <typename, typename, typename...> class OuterC> requires is_assoc_container<OuterC>
+template <template <typename...> class InnerC, template <typename, typename, typename...> class OuterC>
+requires is_assoc_container<OuterC> || is_indexed_storage<OuterC>
 class hetero_container {
+  using type_index = details::type_index<hetero_container>;
+
   template<typename T> static OuterC<hetero_container const *, InnerC<T>> _items;
   template <typename T> static consteval OuterC<hetero_container const *, InnerC<T>> & items()
   requires is_suitable_container<hetero_container const *, InnerC<T>, OuterC> {
@@ -60,19 +106,45 @@ public:
 //  template <typename T> using inner_const_reverse_iterator = typename InnerC<T>::const_reverse_iterator;
 
   hetero_container() = default;
+
+  /**
+   * \brief Creates empty container drawing fractions and bookkeeping from the memory resource
+   * \param resource memory resource, must outlive the container
+   * \note fractions are uses-allocator constructed, so allocator-aware InnerC (std::pmr::vector)
+   *       keeps its elements in the resource as well
+   */
+  explicit hetero_container(std::pmr::memory_resource * resource) noexcept : _resource(resource) {}
+
+  /// \brief Copies elements, the copy uses the default memory resource like std::pmr containers do
   hetero_container(hetero_container const & other) {
     assign(other);
   }
 
-  hetero_container(hetero_container && other)  noexcept {
+  hetero_container(hetero_container const & other, std::pmr::memory_resource * resource) : _resource(resource) {
+    assign(other);
+  }
+
+  /**
+   * \brief Takes over fractions along with the memory resource of the other container
+   * \throw the registry may throw re-keying the fraction nodes (rehash, lock of the sharded_map),
+   *        the indexed storage takes over the fractions table and doesn't throw
+   */
+  hetero_container(hetero_container && other) noexcept(is_indexed_storage<OuterC>) : _resource(other._resource) {
     assign(std::move(other));
   }
 
-  template <typename... Ts> explicit hetero_container(Ts const &... ts) {
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_container> && ...)
+  explicit hetero_container(Ts const &... ts) {
     (push_back(ts), ...);
   }
 
-  template <typename... Ts> explicit hetero_container(Ts &&... ts) {
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_container> && ...)
+  explicit hetero_container(Ts &&... ts) {
+    (push_back(std::move(ts)), ...);
+  }
+
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_container> && ...)
+  hetero_container(std::allocator_arg_t, std::pmr::memory_resource * resource, Ts &&... ts) : _resource(resource) {
     (push_back(std::move(ts)), ...);
   }
 
@@ -85,25 +157,146 @@ public:
     return *this;
   }
 
-  hetero_container & operator=(hetero_container && other) noexcept {
+  hetero_container & operator=(hetero_container && other) {
     assign(std::move(other));
     return *this;
   }
 
   void assign(hetero_container const & other) {
+    if(&other == this) {
+      return;
+    }
     clear();
-    _clear_functions = other._clear_functions;
-    _copy_functions = other._copy_functions;
-    _size_functions = other._size_functions;
-    _empty_functions = other._empty_functions;
-    for (auto && copy_function : _copy_functions) {
-      copy_function(other, *this);
+    _ops = other._ops;
+    for (auto && ops : _ops) {
+      ops->copy(other, *this);
+    }
+    _ordered = other._ordered;
+    _sequence = other._sequence;
+    _present = other._present;
+    _size = other._size;
+    _indexes.clear();
+    for (auto && idx : other._indexes) {
+      _indexes.push_back(idx->clone(_resource));
     }
   }
 
-  void assign(hetero_container && other) noexcept {
-    assign(static_cast<hetero_container const &>(other));
+  /**
+   * \brief Takes over fractions of the other container without touching their elements
+   * \param other container to move from, it's left empty
+   * \note costs O(number of types): the indexed storage moves the fractions table,
+   *       the registry re-keys map nodes of each fraction
+   * \attention memory resources are not propagated, if they differ the elements are moved one by one
+   * \throw like std::pmr::vector, the move of the elements to another memory resource may throw what their
+   *        allocation throws, taking over the fractions of the same resource doesn't allocate
+   */
+  void assign(hetero_container && other) {
+    if(&other == this) {
+      return;
+    }
+    clear();
+    bool const adopt = same_resource(other);
+    if(adopt) {
+      if constexpr(is_indexed_storage<OuterC>) {
+        _fractions = std::move(other._fractions);
+        other._fractions.clear();
+      } else {
+        for (auto && ops : other._ops) {
+          ops->move(other, *this);
+        }
+      }
+      _ops = std::move(other._ops);
+      other._ops.clear();
+      _present = std::move(other._present);
+      other._present.clear();
+      _sequence = std::move(other._sequence);
+      other._sequence.clear();
+      _indexes = std::move(other._indexes);
+    } else {
+      // the fractions of the other container are looked up by its presence bitmap while they are moved
+      try {
+        _present = other._present;
+        _ops = other._ops;
+        _sequence = other._sequence;
+        for (auto && ops : other._ops) {
+          ops->move(other, *this);
+        }
+        _indexes.clear();
+        for (auto && idx : other._indexes) {
+          _indexes.push_back(idx->clone(_resource));
+        }
+      } catch(...) {
+        clear(); // releases the fractions moved so far, the other container keeps the rest
+        throw;
+      }
+    }
+    _ordered = std::exchange(other._ordered, false);
+    other._indexes.clear();
+    _size = std::exchange(other._size, 0);
+    if(!adopt) {
+      other.clear(); // releases what is left of the moved fractions
+    }
+  }
+
+  /**
+   * \brief Exchanges fractions of the containers without touching their elements
+   * \param other container to swap with
+   * \attention swapping containers of different memory resources moves the elements one by one,
+   *            which may throw, see assign(hetero_container &&)
+   */
+  void swap(hetero_container & other) {
+    if(is_indexed_storage<OuterC> && same_resource(other)) {
+      _fractions.swap(other._fractions);
+      _ops.swap(other._ops);
+      _sequence.swap(other._sequence);
+      _indexes.swap(other._indexes);
+      _present.swap(other._present);
+      std::swap(_ordered, other._ordered);
+      std::swap(_size, other._size);
+    } else {
+      hetero_container tmp(std::move(other));
+      other.assign(std::move(*this));
+      assign(std::move(tmp));
+    }
+  }
+
+  friend void swap(hetero_container & lhs, hetero_container & rhs) {
+    lhs.swap(rhs);
+  }
+
+  [[nodiscard]] std::pmr::memory_resource * resource() const noexcept {
+    return _resource;
   }
+
+  /**
+   * \brief Turns on or off the insertion order index used by ordered_visit
+   * \param keep whether to keep the index
+   * \note the index costs 8 bytes per element, appending is O(1), while inserting into the middle
+   *       or erasing is O(size) since offsets of the following elements of the same type are shifted
+   * \attention elements which are already in the container are indexed in the order of their types,
+   *       structural changes made directly through fraction<T>() are not tracked
+   * \throw std::logic_error if InnerC doesn't preserve the order of elements on erasure (slot_map)
+   */
+  void keep_insertion_order(bool keep = true) {
+    if(keep == _ordered) {
+      return;
+    }
+    if(keep && !preserves_order()) {
+      throw std::logic_error("inner container does not preserve the order of elements");
+    }
+    _sequence.clear();
+    _ordered = keep;
+    if(keep) {
+      for (auto && ops : _ops) {
+        ops->index(*this);
+      }
+    }
+  }
+
+  [[nodiscard]] bool keeps_insertion_order() const noexcept {
+    return _ordered;
+  }
+
   /**
    * @brief Inserts new element t before position pos
    * @tparam T -- type bucket
@@ -118,30 +311,34 @@ public:
 
   template<typename T> inner_iterator<T> insert(inner_iterator<T> pos, T && t) {
     // inserts new key or access existing
-    register_operations<T>();
-    auto & c = hetero_container::items<T>()[this];
-    return c.insert(pos, std::forward<T>(t));
+    auto & c = acquire_fraction<T>();
+    auto it = c.insert(pos, std::forward<T>(t));
+    account_insert<T>(c, it);
+    return it;
   }
 
   template <typename T, typename... Args> T & emplace(inner_iterator<T> pos, Args &&... args) {
     // inserts new key or access existing
-    register_operations<T>();
-    auto & c = hetero_container::items<T>()[this];
-    return c.emplace(pos, std::forward<Args>(args)...);
+    auto & c = acquire_fraction<T>();
+    auto it = c.emplace(pos, std::forward<Args>(args)...);
+    account_insert<T>(c, it);
+    return *it;
   }
 
   template <typename T, typename... Args> T & emplace_front(Args &&... args) {
     // inserts new key or access existing
-    register_operations<T>();
-    auto & c = hetero_container::items<T>()[this];
-    return c.emplace(c.begin(), std::forward<Args>(args)...);
+    auto & c = acquire_fraction<T>();
+    auto it = c.emplace(c.begin(), std::forward<Args>(args)...);
+    account_insert<T>(c, it);
+    return *it;
   }
 
   template <typename T, typename... Args> T & emplace_back(Args &&... args) {
     // inserts new key or access existing
-    register_operations<T>();
-    auto & c = hetero_container::items<T>()[this];
-    return c.emplace_back(std::forward<Args>(args)...);
+    auto & c = acquire_fraction<T>();
+    auto & e = c.emplace_back(std::forward<Args>(args)...);
+    account_insert<T>(c, std::prev(std::end(c)));
+    return e;
   }
 
   template<typename... Ts> requires (sizeof...(Ts) > 0) void push_front(Ts const &... ts) {
@@ -168,40 +365,214 @@ public:
     (push_back_single(std::forward<Ts>(ts)), ...);
   }
 
+  /**
+   * \brief Appends elements of the range to the fraction of the type T
+   * \tparam T type of the fraction
+   * \param range elements to append, elements of the owning rvalue range are moved
+   * \note the fraction is looked up once and, if the range is sized, grown by a single allocation
+   */
+  template <typename T, std::ranges::input_range R> requires std::constructible_from<T, std::ranges::range_reference_t<R>>
+  void append_range(R && range) {
+    auto & c = acquire_fraction<T>();
+    auto size = std::size(c);
+    if constexpr(std::ranges::sized_range<R> && requires { c.reserve(size); }) {
+      c.reserve(size + static_cast<std::size_t>(std::ranges::size(range)));
+    }
+    for(auto && e : range) {
+      if constexpr(std::is_lvalue_reference_v<R> || std::ranges::view<std::remove_cvref_t<R>>) {
+        c.emplace_back(std::forward<decltype(e)>(e));
+      } else {
+        c.emplace_back(std::move(e));
+      }
+    }
+    _size += std::size(c) - size;
+    for (auto && idx : _indexes) {
+      if(idx->type() == type_index::template of<T>()) {
+        idx->appended(&c, size);
+      }
+    }
+    sequence_append<T>(size, std::size(c));
+  }
+
+  /**
+   * \brief Reserves capacity of the fractions of the types Ts..., missing fractions are created empty
+   * \tparam Ts types of the fractions
+   * \param ns capacities, one per type
+   * \note fractions without the capacity notion (std::deque) are created only
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0)
+  void reserve(details::count_for<Ts>... ns) {
+    (reserve_single<Ts>(ns), ...);
+  }
+
+  /**
+   * \brief Returns capacity of the fraction of the type T
+   * \return capacity, size for the fractions without the capacity notion, 0 if there is no such fraction
+   */
+  template <typename T> [[nodiscard]] std::size_t capacity() const {
+    if(auto f = find_fraction<T>(); f != nullptr) {
+      if constexpr(requires { f->capacity(); }) {
+        return f->capacity();
+      } else {
+        return f->size();
+      }
+    }
+    return 0;
+  }
+
+  /// \brief Releases unused capacity of all the fractions and of the bookkeeping
+  void shrink_to_fit() {
+    for (auto && ops : _ops) {
+      ops->shrink(*this);
+    }
+    _fractions.shrink_to_fit();
+    _ops.shrink_to_fit();
+    _sequence.shrink_to_fit();
+    _indexes.shrink_to_fit();
+  }
+
+  /// \brief Erases the first element of the type T, the fraction which becomes empty is released
   template<typename T> void pop_front() {
     auto & c = fraction<T>();
+    account_erase<T>(c, c.begin());
     c.erase(c.begin());
+    release_if_empty<T>(c);
   }
 
+  /// \brief Erases the last element of the type T, the fraction which becomes empty is released
   template<typename T> void pop_back() {
     auto & c = fraction<T>();
+    account_erase<T>(c, std::prev(c.end()));
     c.erase(std::prev(c.end()));
+    release_if_empty<T>(c);
   }
 
+  /// \brief Erases the element at the index, the fraction which becomes empty is released
   template<std::equality_comparable T> void erase(std::size_t index) {
     auto & c = fraction<T>();
+    account_erase<T>(c, std::begin(c) + index);
     c.erase(std::begin(c) + index);
-    if(c.empty()) {
-      // TODO: remove dependent *_functions
-    }
+    release_if_empty<T>(c);
   }
 
+  /// \brief Erases the first element equal to e, the fraction which becomes empty is released
   template<std::equality_comparable T> bool erase(T const & e) {
     auto & c = fraction<T>();
     bool erased = false;
     for(auto it = c.begin(); it != c.end(); ++it) {
       if(*it == e) {
+        account_erase<T>(c, it);
         c.erase(it);
         erased = true;
         break;
       }
     }
-    if(c.empty()) {
-      // TODO: remove dependent *_functions
+    release_if_empty<T>(c);
+    return erased;
+  }
+
+  /**
+   * \brief Erases the element of the key from the fraction with keyed access (slot_map)
+   * \return false if there is no element of the key
+   * \note the fraction which becomes empty is released
+   */
+  template <typename T> bool erase(typename InnerC<T>::key_type key) {
+    auto fr = find_fraction<T>();
+    if(fr == nullptr) {
+      return false;
+    }
+    auto it = fr->find(key);
+    if(it == std::end(*fr)) {
+      return false;
+    }
+    account_erase<T>(*fr, it);
+    fr->erase(it);
+    release_if_empty<T>(*fr);
+    return true;
+  }
+
+  /**
+   * \brief Erases all the elements of the type T satisfying the predicate in a single pass
+   * \tparam T type of the fraction
+   * \param f predicate, called once per element in order
+   * \return number of erased elements
+   * \note the fraction which becomes empty is released along with its operations
+   * \throw what the predicate throws, the elements it has picked are erased and the rest are kept,
+   *        the indexes and the insertion order index follow the fraction
+   */
+  template <typename T, typename F> requires std::predicate<F &, T const &>
+  std::size_t erase_if(F && f) {
+    auto fr = find_fraction<T>();
+    if(fr == nullptr) {
+      return 0;
+    }
+    auto & c = *fr;
+    std::size_t erased = 0;
+    std::exception_ptr error;
+    if constexpr(requires { c.erase_if(f); }) {
+      // the fraction reorders its elements itself, insertion order isn't supported for it
+      auto const size = std::size(c);
+      try {
+        c.erase_if(f);
+      } catch(...) {
+        error = std::current_exception();
+      }
+      erased = size - std::size(c);
+      _size -= erased;
+    } else {
+      // new offset + 1 of every element kept, 0 for the erased ones
+      std::pmr::vector<std::uint32_t> remap(_ordered ? std::size(c) : 0, _resource);
+      auto out = std::begin(c);
+      std::uint32_t offset = 0, kept = 0;
+      for(auto it = std::begin(c); it != std::end(c); ++it, ++offset) {
+        if(!error) {
+          try {
+            if(std::invoke(f, std::as_const(*it))) {
+              continue;
+            }
+          } catch(...) {
+            error = std::current_exception(); // the rest of the elements is kept
+          }
+        }
+        if(it != out) {
+          *out = std::move(*it);
+        }
+        ++out;
+        if(_ordered) {
+          remap[offset] = ++kept;
+        }
+      }
+      erased = static_cast<std::size_t>(std::distance(out, std::end(c)));
+      c.erase(out, std::end(c));
+      _size -= erased;
+      if(erased > 0) {
+        for (auto && idx : _indexes) {
+          if(idx->type() == type_index::template of<T>()) {
+            idx->rebuild(&c);
+          }
+        }
+        sequence_remap(static_cast<std::uint32_t>(type_index::template of<T>()), remap);
+      }
+    }
+    release_if_empty<T>(c);
+    if(error) {
+      std::rethrow_exception(error);
     }
     return erased;
   }
 
+  /**
+   * \brief Erases the elements of the types T, Ts... satisfying the generic predicate
+   * \tparam T type to proceed
+   * \tparam Ts types to proceed
+   * \param f predicate accepting every listed type
+   * \return number of erased elements
+   */
+  template <typename T, typename... Ts, typename F>
+  std::size_t erase_if_all(F && f) {
+    return (erase_if<T>(f) + ... + erase_if<Ts>(f));
+  }
+
   template<typename T> T & at(std::size_t index) {
     return fraction<T>().at(index);
   }
@@ -211,18 +582,20 @@ public:
   }
 
   void clear() {
-    for (auto && clear_function : _clear_functions) {
-      clear_function(*this);
+    for (auto && ops : _ops) {
+      ops->release(*this);
+    }
+    _ops.clear();
+    _sequence.clear();
+    _present.clear();
+    _size = 0;
+    for (auto && idx : _indexes) {
+      idx->clear();
     }
   }
 
-  [[nodiscard]] bool empty() const {
-    for (auto && empty_function : _empty_functions) {
-      if(!empty_function(*this)) {
-        return false;
-      }
-    }
-    return true;
+  [[nodiscard]] bool empty() const noexcept {
+    return _size == 0;
   }
 
   template<typename T> [[nodiscard]] size_t count_of() const {
@@ -232,41 +605,250 @@ public:
     return 0;
   }
 
-  [[nodiscard]] size_t size() const {
-    auto safe_int_add = [](std::size_t op1, std::size_t op2) -> std::size_t {
-      if (op2 > std::numeric_limits<std::size_t>::max() - op1) {
-        throw std::overflow_error("Adding overflows");
-      }
-      return op1 + op2;
-    };
-    size_t sum = 0;
-    for (auto && size_function : _size_functions) {
-      sum = safe_int_add(sum, size_function(*this));
+  /**
+   * \brief Returns the number of elements of all the types
+   * \note the count is kept by the container, structural changes made directly through fraction<T>() are not tracked
+   */
+  [[nodiscard]] size_t size() const noexcept {
+    return _size;
+  }
+
+  /**
+   * \brief Reports memory used by the container, in total and per registered type
+   * \return memory report, types are listed in order of registration
+   * \note the object footprint itself is not included, neither are the registry buckets shared
+   *       by all the containers, see registry_stats()
+   */
+  [[nodiscard]] memory_report memory_usage() const {
+    memory_report r;
+    r.types.reserve(_ops.size());
+    for (auto && ops : _ops) {
+      r.types.push_back(ops->usage(*this));
+      r.total += r.types.back().usage;
+    }
+    r.total.bookkeeping_bytes += _fractions.capacity() * sizeof(void *) +
+                                 _ops.capacity() * sizeof(fraction_ops const *) +
+                                 _sequence.capacity() * sizeof(sequence_entry) +
+                                 _indexes.capacity() * sizeof(void *);
+    for (auto && idx : _indexes) {
+      r.total.bookkeeping_bytes += idx->bytes();
     }
-    return sum;
+    return r;
   }
 
+  /**
+   * \brief Reports the process-wide registry of the type T fractions
+   * \tparam T type of the fraction
+   * \return size, bucket count and load factor of the registry
+   */
+  template <typename T> [[nodiscard]] static registry_statistics registry_stats() requires (!is_indexed_storage<OuterC>) {
+    return details::statistics_of(hetero_container::items<T>());
+  }
+
+  /**
+   * \brief Returns the fraction of the type T
+   * \tparam T type of the fraction
+   * \return reference to the fraction
+   * \throw std::out_of_range if the container has no elements of the type T
+   */
   template <typename T> auto fraction() -> InnerC<T> & {
-    return hetero_container::items<T>().at(this);
+    if(auto f = find_fraction<T>(); f != nullptr) {
+      return *f;
+    }
+    throw std::out_of_range(access_error_code(access::error_code::ValueNotFound).message());
   }
 
   template <typename T> auto fraction() const -> InnerC<T> const & {
-    return hetero_container::items<T>().at(this);
+    if(auto f = find_fraction<T>(); f != nullptr) {
+      return *f;
+    }
+    throw std::out_of_range(access_error_code(access::error_code::ValueNotFound).message());
   }
 
-  template <typename T> [[nodiscard]] constexpr bool contains() const {
-    auto & items = hetero_container::items<T>();
-    return items.find(this) != std::cend(items);
+  /**
+   * \brief Returns the handle of the fraction of the type T, which caches the fraction lookup
+   * \tparam T type of the fraction
+   * \return handle of the fraction, see fraction_handle for its validity
+   * \throw std::out_of_range if the container has no elements of the type T
+   */
+  template <typename T> [[nodiscard]] auto handle() -> fraction_handle<InnerC<T>> {
+    return fraction_handle<InnerC<T>>(fraction<T>());
+  }
+
+  template <typename T> [[nodiscard]] auto handle() const -> fraction_handle<InnerC<T> const> {
+    return fraction_handle<InnerC<T> const>(fraction<T>());
+  }
+
+  /**
+   * \brief Returns the lazy view of the fraction of the type T, it composes with the range adaptors without copying
+   * \tparam T type of the fraction
+   * \return view of the elements, empty if the container has no elements of the type T
+   * \note the view refers to the fraction, the modifiers of the fraction invalidate it as they do the iterators
+   */
+  template <typename T> [[nodiscard]] auto view() -> std::ranges::subrange<typename InnerC<T>::iterator> {
+    if(auto f = find_fraction<T>(); f != nullptr) {
+      return {std::begin(*f), std::end(*f)};
+    }
+    return {};
+  }
+
+  template <typename T> [[nodiscard]] auto view() const -> std::ranges::subrange<typename InnerC<T>::const_iterator> {
+    if(auto f = find_fraction<T>(); f != nullptr) {
+      return {std::cbegin(*f), std::cend(*f)};
+    }
+    return {};
+  }
+
+  /**
+   * \brief Returns the lazy view of the elements of the Ts... types, fraction after fraction in the order of the types
+   * \tparam Ts distinct types of the fractions
+   * \return forward view of std::variant<std::reference_wrapper<Ts>...>, the alternative index is the position
+   *         of the element type in Ts...; std::visit the element to get at it
+   * \note the view refers to the fractions, the modifiers of the fractions invalidate it as they do the iterators
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0) && details::is_unique<Ts...>
+  [[nodiscard]] auto joined_view() -> details::joined_view<InnerC<Ts>...> {
+    return details::joined_view<InnerC<Ts>...>(find_fraction<Ts>()...);
+  }
+
+  template <typename... Ts> requires (sizeof...(Ts) > 0) && details::is_unique<Ts...>
+  [[nodiscard]] auto joined_view() const -> details::joined_view<InnerC<Ts> const...> {
+    return details::joined_view<InnerC<Ts> const...>(find_fraction<Ts>()...);
+  }
+
+  /**
+   * \brief Returns the coroutine generator yielding the elements of the Ts... types one by one, fraction after
+   *        fraction in the order of the types
+   * \tparam Ts distinct types of the fractions
+   * \param resource memory resource of the coroutine frame, nullptr stands for the resource of the container
+   * \return input range of std::variant<std::reference_wrapper<Ts const>...>, the traversal runs as the values
+   *         are consumed and begin() continues from where the previous pass stopped
+   * \note the generator refers to the fractions, the modifiers of the fractions invalidate it as they do the iterators
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0) && details::is_unique<Ts...>
+  [[nodiscard]] auto generate(std::pmr::memory_resource * resource = nullptr) const {
+    resource = resource != nullptr ? resource : _resource;
+    return details::generate_range(std::allocator_arg, resource, joined_view<Ts...>());
+  }
+
+  /**
+   * \brief Returns the coroutine generator yielding the elements of the Ts... types in batches
+   * \param batch number of the elements per batch, the last batch may be shorter
+   * \param resource memory resource of the coroutine frame and the batch buffer, nullptr stands for the resource
+   *        of the container
+   * \return input range of std::span of the elements as generate() yields them, the span is valid until
+   *         the generator is advanced
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0) && details::is_unique<Ts...>
+  [[nodiscard]] auto generate_batches(std::size_t batch, std::pmr::memory_resource * resource = nullptr) const {
+    resource = resource != nullptr ? resource : _resource;
+    return details::generate_batches(std::allocator_arg, resource, std::tuple<InnerC<Ts> const *...>(find_fraction<Ts>()...), batch);
+  }
+
+  /**
+   * \brief Builds the hash index of the type T elements by the projection
+   * \tparam T type of the fraction
+   * \param projection pointer to the data member or to the getter, the projected type must be hashable
+   * \details find(), contains(clauses...), query_first() and query_last() look up the clauses of the indexed
+   *          projection through the index instead of scanning the fraction. The container modifiers keep
+   *          the index up to date: appending is O(1), inserting into the middle or erasing is O(size) since
+   *          offsets of the following elements are shifted, erase_if rebuilds it. clear() empties the index.
+   *          The index and its entries are allocated from the memory resource of the container.
+   * \attention the index isn't told about the changes made directly to the fraction: structural changes through
+   *            fraction<T>() and in place changes of the indexed projection through fraction<T>(), handle<T>(),
+   *            view<T>() or visit() corrupt it, the lookups by the new key report the element as missing.
+   *            Change the indexed elements through modify(), or erase and insert them again, or call reindex()
+   *            after the direct changes.
+   * \throw std::logic_error if InnerC doesn't preserve the order of elements on erasure (slot_map)
+   */
+  template <typename T, typename P> requires std::is_member_pointer_v<P> && std::invocable<P const &, T const &>
+  void create_index(P projection) {
+    add_index<details::hash_index, T>(projection);
+  }
+
+  /**
+   * \brief Builds the ordered index of the type T elements by the projection
+   * \tparam T type of the fraction
+   * \param projection pointer to the data member or to the getter, the projected type must be totally ordered
+   * \details query_range() walks the elements within the bounds through the index, find(), contains(clauses...),
+   *          query_first() and query_last() look up the equality and range clauses (lt(), le(), gt(), ge(), between())
+   *          of the indexed projection through it. The index is kept up to date like the hash one, appending
+   *          elements of ascending projections costs O(log size).
+   * \attention direct changes of the fraction corrupt the index as they do the hash one, see create_index()
+   * \throw std::logic_error if InnerC doesn't preserve the order of elements on erasure (slot_map)
+   */
+  template <typename T, typename P> requires std::is_member_pointer_v<P> && std::invocable<P const &, T const &> &&
+                                             std::totally_ordered<std::remove_cvref_t<std::invoke_result_t<P const &, T const &>>>
+  void create_ordered_index(P projection) {
+    add_index<details::ordered_index, T>(projection);
+  }
+
+  /// \brief Checks whether the type T elements are indexed by the projection, see create_index() and create_ordered_index()
+  template <typename T, typename P> requires std::is_member_pointer_v<P> && std::invocable<P const &, T const &>
+  [[nodiscard]] bool has_index(P projection) const noexcept {
+    return find_index<details::hash_index, T>(projection) != nullptr ||
+           find_index<details::ordered_index, T>(projection) != nullptr;
+  }
+
+  /**
+   * \brief Changes the element of the type T in place keeping the indexes of its fraction up to date
+   * \param pos iterator to the element of the fraction
+   * \param fn function changing the element, fn(T &)
+   * \details the element is dropped from the indexes before fn and added back by its new projections after it,
+   *          also when fn throws; O(1) per hash index, O(size) per ordered one
+   */
+  template <typename T, typename F> requires std::invocable<F &, T &>
+  void modify(inner_iterator<T> pos, F && fn) {
+    auto type = type_index::template of<T>();
+    if(_indexes.empty() || !is_present(type)) {
+      std::invoke(fn, *pos);
+      return;
+    }
+    auto & c = fraction<T>();
+    auto offset = static_cast<std::size_t>(std::distance(std::begin(c), pos));
+    auto each_index = [&](auto member) {
+      for(auto && idx : _indexes) {
+        if(idx->type() == type) {
+          ((*idx).*member)(&c, offset);
+        }
+      }
+    };
+    each_index(&details::fraction_index::updating);
+    try {
+      std::invoke(fn, *pos);
+    } catch(...) {
+      each_index(&details::fraction_index::updated);
+      throw;
+    }
+    each_index(&details::fraction_index::updated);
+  }
+
+  /// \brief Rebuilds the indexes of the type T elements after direct changes of the fraction, see create_index()
+  template <typename T> void reindex() {
+    auto fr = find_fraction<T>();
+    for(auto && idx : _indexes) {
+      if(idx->type() == type_index::template of<T>()) {
+        fr != nullptr ? idx->rebuild(fr) : idx->clear();
+      }
+    }
+  }
+
+  template <typename T> [[nodiscard]] constexpr bool contains() const noexcept {
+    return is_present(type_index::template of<T>());
   }
 
   template <std::equality_comparable T, projection_clause... Clauses> requires(sizeof...(Clauses) > 0)
   [[nodiscard]] constexpr bool contains(Clauses &&... clauses) const {
-    auto & items = hetero_container::items<T>();
-    if(auto it = items.find(this); it != std::cend(items)) {
-      auto cmp = [&f = it->second]<typename C>(C && c) -> bool {
-        return std::find_if(std::cbegin(f), std::cend(f), [&c](T && value) {
-          return std::invoke(c.first, value) == c.second;
-        }) != std::cend(f);
+    if(auto fr = find_fraction<T>(); fr != nullptr) {
+      auto cmp = [this, &f = *fr]<typename C>(C && c) -> bool {
+        auto matches = [&c](T const & value) { return clause_matches(c, value); };
+        if(auto offset = this->template indexed_query<T, false>(f, matches, c); offset) {
+          return *offset < std::size(f);
+        }
+        if(auto offset = details::scan_first(f, c); offset) {
+          return *offset < std::size(f);
+        }
+        return std::find_if(std::cbegin(f), std::cend(f), matches) != std::cend(f);
       };
       return (... || cmp(std::forward<Clauses>(clauses)));
     }
@@ -278,13 +860,20 @@ public:
   }
 
   template <typename T, projection_clause Clause> auto find(Clause && clause) const -> std::pair<bool, inner_iterator<T>> {
-    auto & items = hetero_container::items<T>();
-    if(auto it = items.find(this); it != std::cend(items)) {
-      auto found = std::find_if(std::begin(it->second), std::end(it->second),
-                                [clause](T const & that) {
-                                  return std::invoke(clause.first, that) == clause.second;
-                                });
-      if(found != std::end(it->second)) {
+    if(auto fr = find_fraction<T>(); fr != nullptr) {
+      auto matches = [&clause](T const & that) { return clause_matches(clause, that); };
+      auto offset = indexed_query<T, false>(*fr, matches, clause);
+      if(!offset) {
+        offset = details::scan_first(*fr, clause);
+      }
+      if(offset) {
+        if(*offset < std::size(*fr)) {
+          return std::make_pair(true, std::next(std::begin(*fr), *offset));
+        }
+        return std::make_pair(false, typename InnerC<T>::iterator{});
+      }
+      auto found = std::find_if(std::begin(*fr), std::end(*fr), matches);
+      if(found != std::end(*fr)) {
         return std::make_pair(true, found);
       }
     }
@@ -307,6 +896,35 @@ public:
     };
   }
 
+  /**
+   * \brief Generates elements accessor for Ts... types walking elements in the order they were added
+   * \tparam Ts types to proceed, elements of other types are skipped
+   * \return function which applies visitor F on elements of specified types, elements are read from their fractions
+   * \throw std::logic_error if the container doesn't keep the insertion order
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0)
+  [[nodiscard]] auto ordered_visit() const {
+    if(!_ordered) {
+      throw std::logic_error("insertion order is not kept, see keep_insertion_order()");
+    }
+    return [this]<typename F>(F && f) -> VisitorReturn {
+      static_assert((std::is_invocable_v<F, Ts> && ...), "predicate should accept provided types");
+      std::tuple<InnerC<Ts> const *...> fractions{find_fraction<Ts>()...};
+      std::array<std::size_t, sizeof...(Ts)> const types{type_index::template of<Ts>()...};
+      for(auto && e : _sequence) {
+        auto ret = VisitorReturn::Continue;
+        [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+          ((e.type == types[Is] ? (ret = f(*std::next(std::begin(*std::get<Is>(fractions)), e.offset)), true) : false) || ...);
+        }(std::index_sequence_for<Ts...>{});
+        if(ret == VisitorReturn::Break) {
+          return VisitorReturn::Break;
+        }
+      }
+      return VisitorReturn::Continue;
+    };
+  }
+
   /**
    * \brief Generates elements accessor for T, Ts... types by predicate F
    * \tparam T type to proceed
@@ -321,20 +939,66 @@ public:
     };
   }
 
+  /**
+   * \brief Generates elements accessor for Ts... types running the visitor F on the threads of the policy
+   * \tparam Ts types to proceed
+   * \param policy threads and chunk size, fractions of different types and chunks of large fractions run concurrently
+   * \return function which applies visitor F on elements of specified types, Break returned by F cancels the run
+   *         cooperatively: elements already being visited complete, the rest are skipped
+   * \note visitor is invoked concurrently, it has to be thread safe; the elements are visited in no particular order
+   * \throw rethrows the first exception thrown by the visitor
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0)
+  [[nodiscard]] auto visit_par(parallel_policy policy = {}) const {
+    return [this, policy]<typename F>(F && f) -> VisitorReturn {
+      static_assert((std::is_invocable_v<F, Ts> && ...), "predicate should accept provided types");
+      details::cancellation cancel;
+      for_each_par<Ts...>(policy, cancel, [&f, &cancel](auto & e) {
+        if(f(e) == VisitorReturn::Break) {
+          cancel.request();
+        }
+      });
+      return cancel.requested() ? VisitorReturn::Break : VisitorReturn::Continue;
+    };
+  }
+
+  /**
+   * \brief Generates elements accessor for Ts... types running the predicates on the threads of the policy
+   * \tparam Ts types to proceed
+   * \param policy threads and chunk size, see visit_par()
+   * \return function which applies the predicate applicable to the type on the elements of the type,
+   *         true if all the types are present
+   * \note unlike match(), fractions following the missing one are processed as well
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename... Ts> requires (sizeof...(Ts) > 0)
+  [[nodiscard]] auto match_par(parallel_policy policy = {}) const {
+    return [this, policy]<typename... Fs>(Fs &&... fs) -> bool {
+      details::cancellation cancel;
+      for_each_par<Ts...>(policy, cancel, [&fs...]<typename E>(E & e) {
+        stg::util::fn_select_applicable<std::remove_cvref_t<E>>::check(fs...)(e);
+      });
+      return (contains<Ts>() && ...);
+    };
+  }
+
   template <typename... Ts> auto to_tuple() const -> std::tuple<safe_ref<Ts>...> {
     if(!(contains<safe_ref<Ts>>() && ...)) {
       throw std::out_of_range("try to access unbounded value");
     }
-    (type_offset<safe_ref<Ts>>::reset(), ...);
-    return {fraction<safe_ref<Ts>>().at(type_offset<safe_ref<Ts>>().offset - 1) ...};
+    return [this]<std::size_t... Is>(std::index_sequence<Is...>) -> std::tuple<safe_ref<Ts>...> {
+      return {fraction<safe_ref<Ts>>().at(details::occurrence_of<Is, safe_ref<Ts>...>()) ...};
+    }(std::index_sequence_for<Ts...>{});
   }
 
   template <typename... Ts> auto try_to_tuple() const -> expected<std::tuple<safe_ref<Ts>...>, access::error_code> {
     if(!(contains<safe_ref<Ts>>() && ...)) {
       return make_unexpected(access::error_code::ValueNotFound);
     }
-    (type_offset<safe_ref<Ts>>::reset(), ...);
-    return {{fraction<safe_ref<Ts>>().at(type_offset<safe_ref<Ts>>().offset - 1) ...}};
+    return [this]<std::size_t... Is>(std::index_sequence<Is...>) -> expected<std::tuple<safe_ref<Ts>...>, access::error_code> {
+      return {{fraction<safe_ref<Ts>>().at(details::occurrence_of<Is, safe_ref<Ts>...>()) ...}};
+    }(std::index_sequence_for<Ts...>{});
   }
 
   // Find/Query accessors
@@ -346,8 +1010,17 @@ public:
   std::pair<bool, typename hetero_container<IC, OC>::template inner_iterator<T>>;
 
   template<typename... Ts, template <typename...> class IC, template <typename, typename, typename...> class OC, std::invocable<Ts...> F>
+  requires (sizeof...(Ts) > 1)
   friend constexpr auto find_first(hetero_container<IC, OC> const & hc, F && f) ->
   std::pair<bool, std::tuple<typename hetero_container<IC, OC>::template inner_iterator<Ts>...>>;
+  template<typename A, typename B, template <typename...> class IC, template <typename, typename, typename...> class OC, typename PA, typename PB, typename F>
+  requires std::invocable<PA const &, A const &> && std::invocable<PB const &, B const &> && std::predicate<F &, A const &, B const &>
+  friend auto find_first(hetero_container<IC, OC> const & hc, PA const & pa, PB const & pb, F && f) ->
+  std::pair<bool, std::tuple<typename hetero_container<IC, OC>::template inner_iterator<A>, typename hetero_container<IC, OC>::template inner_iterator<B>>>;
+  template<typename A, typename B, template <typename...> class IC, template <typename, typename, typename...> class OC, typename PA, typename PB, typename F>
+  requires std::invocable<PA const &, A const &> && std::invocable<PB const &, B const &> && std::predicate<F &, A const &, B const &>
+  friend auto join(hetero_container<IC, OC> const & hc, PA const & pa, PB const & pb, F && f) ->
+  std::vector<std::pair<typename hetero_container<IC, OC>::template inner_iterator<A>, typename hetero_container<IC, OC>::template inner_iterator<B>>>;
 
   template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, std::invocable<T> F>
   friend constexpr auto find_next(hetero_container<IC, OC> const & hc, typename hetero_container<IC, OC>::template inner_iterator<T> pos, F && f) ->
@@ -362,6 +1035,14 @@ public:
 
   template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, std::output_iterator<T> O, std::invocable<T> F>
   friend constexpr bool find_all(hetero_container<IC, OC> const & hc, O output, F && f);
+  template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, std::invocable<T> F>
+  friend auto match_bitmap(hetero_container<IC, OC> const & hc, F const & f) -> std::vector<std::uint64_t>;
+  template <typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, std::output_iterator<T> O, std::invocable<T> F>
+  friend bool find_all(hetero_container<IC, OC> const & hc, parallel_policy const & policy, O output, F && f);
+  template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, std::invocable<T> F>
+  friend auto count_if(hetero_container<IC, OC> const & hc, F && f) -> std::size_t;
+  template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, std::invocable<T> F>
+  friend auto count_if(hetero_container<IC, OC> const & hc, parallel_policy const & policy, F && f) -> std::size_t;
 
   template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, projection_clause Clause, projection_clause... Clauses>
   friend constexpr auto query_first(hetero_container<IC, OC> const & hc, Clause && clause, Clauses &&... clauses) ->
@@ -381,6 +1062,17 @@ public:
   friend constexpr auto query_last_if(hetero_container<IC, OC> const & hc, F && f, Clause && clause, Clauses &&... clauses) ->
   std::pair<bool, typename hetero_container<IC, OC>::template inner_iterator<T>>;
 
+  template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, projection_clause Clause>
+  friend auto query_range(hetero_container<IC, OC> const & hc, Clause const & clause);
+
+  template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, query_expression E>
+  friend constexpr auto query_first(hetero_container<IC, OC> const & hc, E const & expression) ->
+  std::pair<bool, typename hetero_container<IC, OC>::template inner_iterator<T>>;
+
+  template<typename T, template <typename...> class IC, template <typename, typename, typename...> class OC, query_expression E>
+  friend constexpr auto query_last(hetero_container<IC, OC> const & hc, E const & expression) ->
+  std::pair<bool, typename hetero_container<IC, OC>::template inner_iterator<T>>;
+
 private:
   // inserts new key or access existing
   template<typename T> auto push_front_single(const T & t) -> hetero_container::inner_iterator<T> {
@@ -394,9 +1086,10 @@ private:
 
   // inserts new key or access existing
   template<typename T> auto push_front_single(T && t) -> hetero_container::inner_iterator<T> {
-    register_operations<T>();
-    auto & c = hetero_container::items<T>()[this];
-    return c.insert(std::begin(c), std::forward<T>(t));
+    auto & c = acquire_fraction<T>();
+    auto it = c.insert(std::begin(c), std::forward<T>(t));
+    account_insert<T>(c, it);
+    return it;
   }
 
   template<typename T> auto push_back_single(const T & t) -> hetero_container::inner_iterator<T> {
@@ -409,9 +1102,257 @@ private:
 
   // inserts new key or access existing
   template<typename T> auto push_back_single(T && t) -> hetero_container::inner_iterator<T> {
-    register_operations<T>();
-    auto & c = hetero_container::items<T>()[this];
-    return c.insert(std::end(c), std::forward<T>(t));
+    auto & c = acquire_fraction<T>();
+    auto it = c.insert(std::end(c), std::forward<T>(t));
+    account_insert<T>(c, it);
+    return it;
+  }
+
+  template <typename T> void reserve_single(std::size_t n) {
+    auto & c = acquire_fraction<T>();
+    if constexpr(requires { c.reserve(n); }) {
+      c.reserve(n);
+    }
+  }
+
+  // counts the inserted element, updates the indexes and appends it to the insertion order index shifting the following elements of its fraction;
+  // if the bookkeeping throws the element is erased again, so the container is left as it was before the insertion
+  template <typename T> void account_insert(InnerC<T> & c, typename InnerC<T>::iterator pos) {
+    if(!_ordered && _indexes.empty()) {
+      ++_size;
+      return;
+    }
+    auto type = static_cast<std::uint32_t>(type_index::template of<T>());
+    auto offset = static_cast<std::size_t>(std::distance(std::begin(c), pos));
+    std::size_t updated = 0;
+    try {
+      if(_ordered) {
+        if(offset > std::numeric_limits<std::uint32_t>::max()) {
+          throw std::length_error("fraction is too large for the insertion order index");
+        }
+        if(_sequence.size() == _sequence.capacity()) {
+          _sequence.reserve(std::max<std::size_t>(2 * _sequence.size(), 1));
+        }
+      }
+      for (auto && idx : _indexes) {
+        if(idx->type() == type) {
+          idx->inserted(&c, offset);
+        }
+        ++updated;
+      }
+    } catch(...) {
+      for (auto && idx : _indexes | std::views::take(updated)) {
+        if(idx->type() == type) {
+          idx->erasing(&c, offset);
+        }
+      }
+      c.erase(pos);
+      throw;
+    }
+    ++_size;
+    if(!_ordered) {
+      return;
+    }
+    if(std::next(pos) != std::end(c)) {
+      for(auto & e : _sequence) {
+        if(e.type == type && e.offset >= offset) {
+          ++e.offset;
+        }
+      }
+    }
+    _sequence.push_back({type, static_cast<std::uint32_t>(offset)});
+  }
+
+  // uncounts the element to be erased, drops it from the indexes and from the insertion order index shifting the following elements of its fraction
+  template <typename T> void account_erase(InnerC<T> const & c, typename InnerC<T>::const_iterator pos) {
+    --_size;
+    if(!_ordered && _indexes.empty()) {
+      return;
+    }
+    auto type = static_cast<std::uint32_t>(type_index::template of<T>());
+    for (auto && idx : _indexes) {
+      if(idx->type() == type) {
+        idx->erasing(&c, static_cast<std::size_t>(std::distance(std::cbegin(c), pos)));
+      }
+    }
+    if(!_ordered) {
+      return;
+    }
+    auto offset = static_cast<std::uint32_t>(std::distance(std::cbegin(c), pos));
+    auto out = std::begin(_sequence);
+    for(auto e : _sequence) {
+      if(e.type == type) {
+        if(e.offset == offset) {
+          continue;
+        }
+        e.offset -= e.offset > offset ? 1 : 0;
+      }
+      *out++ = e;
+    }
+    _sequence.erase(out, std::end(_sequence));
+  }
+
+  // appends the elements [from, to) of the fraction of the type T to the insertion order index
+  template <typename T> void sequence_append(std::size_t from, std::size_t to) {
+    if(!_ordered) {
+      return;
+    }
+    if(to > std::size_t{std::numeric_limits<std::uint32_t>::max()} + 1) {
+      throw std::length_error("fraction is too large for the insertion order index");
+    }
+    auto type = static_cast<std::uint32_t>(type_index::template of<T>());
+    _sequence.reserve(_sequence.size() + (to - from));
+    for(auto offset = from; offset < to; ++offset) {
+      _sequence.push_back({type, static_cast<std::uint32_t>(offset)});
+    }
+  }
+
+  // drops the erased elements of the fraction from the insertion order index, remap holds new offset + 1 or 0
+  void sequence_remap(std::uint32_t type, std::pmr::vector<std::uint32_t> const & remap) {
+    if(!_ordered) {
+      return;
+    }
+    auto out = std::begin(_sequence);
+    for(auto e : _sequence) {
+      if(e.type == type) {
+        if(remap[e.offset] == 0) {
+          continue;
+        }
+        e.offset = remap[e.offset] - 1;
+      }
+      *out++ = e;
+    }
+    _sequence.erase(out, std::end(_sequence));
+  }
+
+  // appends all the elements of the fraction to the insertion order index
+  template <typename T> void sequence_index() {
+    sequence_append<T>(0, find_fraction<T>()->size());
+  }
+
+  // whether erasure keeps the order of the remaining elements, which the insertion order index and the indexes rely on
+  static constexpr bool preserves_order() noexcept {
+    if constexpr(requires { InnerC<int>::preserves_order; }) {
+      return InnerC<int>::preserves_order;
+    } else {
+      return true;
+    }
+  }
+
+  template <template <typename, typename, typename> class Index, typename T, typename P> void add_index(P projection) {
+    if(!preserves_order()) {
+      throw std::logic_error("inner container does not preserve the order of elements");
+    }
+    if(find_index<Index, T>(projection) != nullptr) {
+      return;
+    }
+    auto idx = details::make_index<Index<T, InnerC<T>, P>>(_resource, type_index::template of<T>(), projection);
+    if(auto fr = find_fraction<T>(); fr != nullptr) {
+      idx->rebuild(fr);
+    }
+    _indexes.push_back(std::move(idx));
+  }
+
+  // looks up the index of the kind Index of the type T elements by the projection
+  template <template <typename, typename, typename> class Index, typename T, typename P>
+  auto find_index(P const & projection) const noexcept -> Index<T, InnerC<T>, P> const * {
+    using index_type = Index<T, InnerC<T>, P>;
+    for (auto && idx : _indexes) {
+      if(idx->type() == type_index::template of<T>() && idx->tag() == index_type::kind() &&
+         static_cast<index_type const &>(*idx).projection() == projection) {
+        return static_cast<index_type const *>(idx.get());
+      }
+    }
+    return nullptr;
+  }
+
+  // expressions without the top-level conjunction (||, !, !=) have no clauses to look up
+  template <typename T, bool Last, typename F>
+  auto indexed_query(InnerC<T> const &, F const &) const -> std::optional<std::size_t> {
+    return std::nullopt;
+  }
+
+  /**
+   * \brief Looks up the first (or the last) element matching the predicate through the index of one of the clauses,
+   *        the hash index is preferred for the equality clause
+   * \param pred predicate which implies all the clauses
+   * \return offset of the element, size of the fraction if there is no such element
+   *         or nullopt if none of the clauses is indexed
+   */
+  template <typename T, bool Last, typename F, typename... Clauses> requires (sizeof...(Clauses) > 0)
+  auto indexed_query(InnerC<T> const & c, F const & pred, Clauses const &... clauses) const -> std::optional<std::size_t> {
+    std::optional<std::size_t> found;
+    if(_indexes.empty()) {
+      return found;
+    }
+    auto offset = std::size(c);
+    // keeps the first (or the last) of the candidates matching all the clauses
+    auto pick = [&](std::size_t o) {
+      if(offset != std::size(c) && (Last ? o < offset : o > offset)) {
+        return;
+      }
+      if(pred(*std::next(std::begin(c), o))) {
+        offset = o;
+      }
+    };
+    auto lookup = [&]<typename Clause>(Clause const & clause) -> bool {
+      using P = std::remove_cvref_t<decltype(clause.first)>;
+      using V = std::remove_cvref_t<decltype(clause.second)>;
+      if constexpr(std::is_member_pointer_v<P> && std::invocable<P const &, T const &>) {
+        using key_type = std::remove_cvref_t<std::invoke_result_t<P const &, T const &>>;
+        if constexpr(!is_bounds<V> && std::is_constructible_v<key_type, V const &>) {
+          if(auto idx = find_index<details::hash_index, T>(clause.first); idx != nullptr) {
+            for(auto [first, last] = idx->equal_range(key_type(clause.second)); first != last; ++first) {
+              pick(first->second);
+            }
+            found = offset;
+            return true;
+          }
+        }
+        if constexpr(std::totally_ordered_with<key_type, clause_value_t<V>>) {
+          if(auto idx = find_index<details::ordered_index, T>(clause.first); idx != nullptr) {
+            auto range = [&] {
+              if constexpr(is_bounds<V>) {
+                return idx->range(clause.second);
+              } else {
+                return idx->range(bounds<V>{clause.second, clause.second});
+              }
+            }();
+            for(auto && e : range) {
+              pick(e.offset);
+            }
+            found = offset;
+            return true;
+          }
+        }
+      }
+      return false;
+    };
+    (void)(... || lookup(clauses));
+    return found;
+  }
+
+  /**
+   * \brief Hash join of the T fraction (the probe side) against the U fraction (the build side) by the keys
+   *        of the projections; the hash index of U by the projection serves the build side if there is one,
+   *        the transient table over U allocated from the resource of the container otherwise
+   * \param emit invoked with the offsets of T and U elements of equal keys in the order of T then U, the join
+   *        stops once it returns false
+   */
+  template <typename T, typename U, typename PT, typename PU, typename F>
+  void join_offsets(InnerC<T> const & probe, PT const & pt, InnerC<U> const & build, PU const & pu, F && emit) const {
+    using probe_key = std::remove_cvref_t<std::invoke_result_t<PT const &, T const &>>;
+    using build_key = std::remove_cvref_t<std::invoke_result_t<PU const &, U const &>>;
+    // the index is probed when its key type holds the probe keys without narrowing
+    if constexpr(std::same_as<std::common_type_t<probe_key, build_key>, build_key>) {
+      if(auto idx = find_index<details::hash_index, U>(pu); idx != nullptr) {
+        details::index_lookup lookup(*idx);
+        details::probe_join(probe, pt, lookup, std::forward<F>(emit));
+        return;
+      }
+    }
+    details::join_table<std::common_type_t<probe_key, build_key>> table(build, pu, _resource);
+    details::probe_join(probe, pt, table, std::forward<F>(emit));
   }
 
   template<typename T, typename U> auto visit_single(T const & visitor) const -> VisitorReturn {
@@ -420,9 +1361,8 @@ private:
 
   template<typename T, typename U> auto visit_single(T && visitor) const -> VisitorReturn {
     static_assert(std::is_invocable_v<T, U>, "predicate should accept provided type");
-    auto & items = hetero_container::items<U>();
-    if(auto iter = items.find(this); iter != std::cend(items)) {
-      for(auto & c : iter->second) {
+    if(auto fr = find_fraction<U>(); fr != nullptr) {
+      for(auto & c : *fr) {
         if(visitor(c) == VisitorReturn::Break) {
           return VisitorReturn::Break;
         }
@@ -431,11 +1371,48 @@ private:
     return VisitorReturn::Continue;
   }
 
+  /**
+   * \brief Applies the function to the elements of the Ts... fractions on the threads of the policy
+   * \details fractions of random access containers are split into chunks of policy.grain elements,
+   * the other ones are a single chunk each; the workers stop taking elements once the cancellation is requested
+   */
+  template <typename... Ts, typename Fn>
+  void for_each_par(parallel_policy const & policy, details::cancellation & cancel, Fn const & fn) const {
+    std::tuple<InnerC<Ts> *...> fractions{find_fraction<Ts>()...};
+    std::vector<details::fraction_chunk> chunks;
+    auto grain = std::max<std::size_t>(policy.grain, 1);
+    [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      ([&](auto fr) {
+        auto size = fr != nullptr ? std::size(*fr) : 0;
+        if constexpr(std::random_access_iterator<typename std::remove_pointer_t<decltype(fr)>::iterator>) {
+          for(std::size_t first = 0; first < size; first += grain) {
+            chunks.push_back({Is, first, std::min(first + grain, size)});
+          }
+        } else if(size > 0) {
+          chunks.push_back({Is, 0, size});
+        }
+      }(std::get<Is>(fractions)), ...);
+    }(std::index_sequence_for<Ts...>{});
+    details::run_parallel(policy, chunks.size(), [&](std::size_t i) {
+      auto const & chunk = chunks[i];
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        ((chunk.type == Is ? (for_each_chunk(*std::get<Is>(fractions), chunk, cancel, fn), true) : false) || ...);
+      }(std::index_sequence_for<Ts...>{});
+    }, cancel);
+  }
+
+  template <typename C, typename Fn>
+  static void for_each_chunk(C & fr, details::fraction_chunk const & chunk, details::cancellation const & cancel, Fn const & fn) {
+    auto first = std::next(std::begin(fr), static_cast<std::ptrdiff_t>(chunk.first));
+    for(auto i = chunk.first; i < chunk.last && !cancel.requested(); ++i, ++first) {
+      fn(*first);
+    }
+  }
+
   template <typename T, typename... Fs> constexpr bool match_single(Fs &&... fs) const {
     auto f = stg::util::fn_select_applicable<T>::check(std::forward<Fs>(fs)...);
-    auto & items = hetero_container::items<T>();
-    if(auto iter = items.find(this); iter != std::cend(items)) {
-      for(auto & c : iter->second) {
+    if(auto fr = find_fraction<T>(); fr != nullptr) {
+      for(auto & c : *fr) {
         f(c);
       }
       return true;
@@ -443,33 +1420,182 @@ private:
     return false;
   }
 
-  template<typename T> void register_operations() {
-    // don't have it yet, so create functions for copying, moving, destroying, etc
-    if(!contains<T>()) {
-      _clear_functions.emplace_back([](hetero_container & c) { hetero_container::items<T>().erase(&c); });
-      // if someone copies me, they need to call each copy_function and pass themself
-      _copy_functions.emplace_back([](const hetero_container & from, hetero_container & to) {
-        auto & items = hetero_container::items<T>();
-        if(&to != &from) {
-          if constexpr(std::is_copy_constructible_v<T>) {
-            items[&to] = items[&from];
-          } else {
-            items[&to] = std::move(items[&from]);
-          }
+  /**
+   * \brief Looks up the fraction of the type T
+   * \return pointer to the fraction or nullptr if the container has no such fraction
+   */
+  template <typename T> auto find_fraction() const -> InnerC<T> * {
+    if constexpr(is_indexed_storage<OuterC>) {
+      auto id = type_index::template of<T>();
+      return id < _fractions.size() ? static_cast<InnerC<T> *>(_fractions[id]) : nullptr;
+    } else {
+      if(!is_present(type_index::template of<T>())) {
+        return nullptr;
+      }
+      auto & items = hetero_container::items<T>();
+      auto it = items.find(this);
+      return it != std::end(items) ? &it->second : nullptr;
+    }
+  }
+
+  // creates storage of the fraction without operations registering
+  template <typename T> auto emplace_fraction() -> InnerC<T> & {
+    if constexpr(is_indexed_storage<OuterC>) {
+      auto id = type_index::template of<T>();
+      if(id >= _fractions.size()) {
+        _fractions.resize(id + 1);
+      }
+      if(_fractions[id] == nullptr) {
+        _fractions[id] = std::pmr::polymorphic_allocator<>(_resource).template new_object<InnerC<T>>();
+      }
+      return *static_cast<InnerC<T> *>(_fractions[id]);
+    } else if constexpr(std::uses_allocator_v<InnerC<T>, std::pmr::polymorphic_allocator<>>) {
+      return hetero_container::items<T>().try_emplace(this, typename InnerC<T>::allocator_type(_resource)).first->second;
+    } else {
+      return hetero_container::items<T>()[this];
+    }
+  }
+
+  // inserts new fraction with its operations or access existing
+  template <typename T> auto acquire_fraction() -> InnerC<T> & {
+    if(auto f = find_fraction<T>(); f != nullptr) {
+      return *f;
+    }
+    _ops.push_back(&ops_of<T>);
+    set_present(type_index::template of<T>(), true);
+    return emplace_fraction<T>();
+  }
+
+  template <typename T> void release_fraction() {
+    set_present(type_index::template of<T>(), false);
+    if constexpr(is_indexed_storage<OuterC>) {
+      if(auto id = type_index::template of<T>(); id < _fractions.size()) {
+        if(auto f = static_cast<InnerC<T> *>(std::exchange(_fractions[id], nullptr)); f != nullptr) {
+          std::pmr::polymorphic_allocator<>(_resource).delete_object(f);
         }
-      });
-      _size_functions.emplace_back([](const hetero_container & c) { return hetero_container::items<T>().at(&c).size(); });
-      _empty_functions.emplace_back([](const hetero_container & c) { return hetero_container::items<T>().at(&c).empty(); });
+      }
+    } else {
+      hetero_container::items<T>().erase(this);
+    }
+  }
+
+  // releases the fraction which became empty along with its operations, so they don't weigh on size() and clear()
+  template <typename T> void release_if_empty(InnerC<T> const & c) {
+    if(std::empty(c)) {
+      release_fraction<T>();
+      std::erase(_ops, &ops_of<T>);
+    }
+  }
+
+  template <typename T> void copy_fraction(hetero_container const & from) {
+    if(&from != this) {
+      auto & dst = emplace_fraction<T>();
+      if constexpr(std::is_copy_constructible_v<T>) {
+        dst = *from.template find_fraction<T>();
+      } else {
+        dst = std::move(*from.template find_fraction<T>());
+      }
+    }
+  }
+
+  // re-keys the registry node of the fraction, the indexed storage moves the whole table instead,
+  // elements of the fraction allocated by the foreign memory resource are moved one by one
+  template <typename T> void move_fraction(hetero_container & from) {
+    if(!same_resource(from)) {
+      emplace_fraction<T>() = std::move(*from.template find_fraction<T>());
+    } else if constexpr(!is_indexed_storage<OuterC>) {
+      auto & items = hetero_container::items<T>();
+      if constexpr(requires { items.extract(&from); }) {
+        if(auto node = items.extract(&from); !node.empty()) {
+          node.key() = this;
+          items.insert(std::move(node));
+        }
+      } else if(auto it = items.find(&from); it != std::end(items)) {
+        items.insert_or_assign(this, std::move(it->second));
+        items.erase(&from);
+      }
+    }
+  }
+
+  template <typename T> void shrink_fraction() {
+    if constexpr(requires (InnerC<T> & f) { f.shrink_to_fit(); }) {
+      find_fraction<T>()->shrink_to_fit();
+    }
+  }
+
+  template <typename T> auto fraction_usage() const -> type_memory_usage {
+    auto & f = *find_fraction<T>();
+    auto u = details::usage_of<T>(f);
+    if constexpr(!is_indexed_storage<OuterC>) {
+      // the fraction is kept by the registry node keyed by the container address
+      u.bookkeeping_bytes += details::node_bytes<OuterC<hetero_container const *, InnerC<T>>> - sizeof(InnerC<T>);
     }
+    return {typeid(T), typeid(void), f.size(), u};
   }
 
-  std::vector<std::function<void(hetero_container&)>> _clear_functions;
-  std::vector<std::function<void(const hetero_container&, hetero_container&)>> _copy_functions;
-  std::vector<std::function<size_t(const hetero_container&)>> _size_functions;
-  std::vector<std::function<bool(const hetero_container&)>> _empty_functions;
+  // type-erased operations over the fraction of a single type
+  struct fraction_ops {
+    void (*release)(hetero_container &);
+    void (*copy)(hetero_container const &, hetero_container &);
+    void (*move)(hetero_container &, hetero_container &);
+    void (*index)(hetero_container &);
+    type_memory_usage (*usage)(hetero_container const &);
+    void (*shrink)(hetero_container &);
+  };
+
+  template <typename T> static constexpr fraction_ops ops_of{
+    [](hetero_container & c) { c.template release_fraction<T>(); },
+    [](hetero_container const & from, hetero_container & to) { to.template copy_fraction<T>(from); },
+    [](hetero_container & from, hetero_container & to) { to.template move_fraction<T>(from); },
+    [](hetero_container & c) { c.template sequence_index<T>(); },
+    [](hetero_container const & c) -> type_memory_usage { return c.template fraction_usage<T>(); },
+    [](hetero_container & c) { c.template shrink_fraction<T>(); }
+  };
+
+  [[nodiscard]] bool same_resource(hetero_container const & other) const noexcept {
+    return _resource == other._resource || _resource->is_equal(*other._resource);
+  }
+
+  [[nodiscard]] bool is_present(std::size_t id) const noexcept {
+    return id / 64 < _present.size() && ((_present[id / 64] >> (id % 64)) & 1u) != 0;
+  }
+
+  void set_present(std::size_t id, bool present) {
+    if(id / 64 >= _present.size()) {
+      if(!present) {
+        return;
+      }
+      _present.resize(id / 64 + 1);
+    }
+    auto bit = std::uint64_t{1} << (id % 64);
+    _present[id / 64] = present ? _present[id / 64] | bit : _present[id / 64] & ~bit;
+  }
+
+  std::pmr::memory_resource * _resource = std::pmr::get_default_resource();
+  // per-instance fractions table of the indexed storage, position is the dense type id
+  std::pmr::vector<void *> _fractions = std::pmr::vector<void *>(_resource);
+  // operations of the registered types, in order of registration
+  std::pmr::vector<fraction_ops const *> _ops = std::pmr::vector<fraction_ops const *>(_resource);
+
+  // element of the insertion order index
+  struct sequence_entry {
+    std::uint32_t type;   // dense type id
+    std::uint32_t offset; // position in the fraction
+  };
+
+  bool _ordered = false;
+  std::pmr::vector<sequence_entry> _sequence = std::pmr::vector<sequence_entry>(_resource);
+
+  // number of elements of all the types
+  std::size_t _size = 0;
+  // bitmap of the types having a fraction, bit position is the dense type id
+  std::pmr::vector<std::uint64_t> _present = std::pmr::vector<std::uint64_t>(_resource);
+  // secondary indexes of the fractions, see create_index()
+  std::pmr::vector<details::index_ptr> _indexes = std::pmr::vector<details::index_ptr>(_resource);
 };
 
-template <template <typename...> class InnerC, template <typename, typename, typename...> class OuterC> requires is_assoc_container<OuterC>
+template <template <typename...> class InnerC, template <typename, typename, typename...> class OuterC>
+requires is_assoc_container<OuterC> || is_indexed_storage<OuterC>
 template<typename T>
 OuterC<hetero_container<InnerC, OuterC> const *, InnerC<T>> hetero_container<InnerC, OuterC>::_items;
 
@@ -485,9 +1611,14 @@ OuterC<hetero_container<InnerC, OuterC> const *, InnerC<T>> hetero_container<Inn
 template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
 constexpr auto find_first(hetero_container<InnerC, OuterC> const & hc, F && f) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if(iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    return find_next<T>(hc, iter->second.begin(), f);
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    if(auto offset = details::scan_first(*fr, f); offset) {
+      if(*offset < std::size(*fr)) {
+        return std::pair{true, std::next(fr->begin(), *offset)};
+      }
+    } else if(auto found = std::find_if(fr->begin(), fr->end(), std::forward<F>(f)); found != fr->end()) {
+      return std::pair{true, found};
+    }
   }
   return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
 }
@@ -495,16 +1626,120 @@ std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterat
 template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
 constexpr auto find_next(hetero_container<InnerC, OuterC> const & hc, typename hetero_container<InnerC, OuterC>::template inner_iterator<T> pos, F && f) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if(iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    auto found = std::find_if(std::next(pos), iter->second.end(), std::forward<F>(f));
-    if(found != iter->second.end()) {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    auto found = std::find_if(std::next(pos), fr->end(), std::forward<F>(f));
+    if(found != fr->end()) {
       return std::pair{true, found};
     }
   }
   return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
 }
 
+/**
+ * \brief Finds the first tuple of the elements of the Ts... types matched against predicate F
+ * \tparam Ts types of the elements, one element of every type makes the tuple
+ * \param f match predicate invoked with the elements of the tuple, f(Ts const &...)
+ * \return pair of presence flag and tuple of the iterators to the elements; the tuples are tried in nested loops
+ *         over the fractions, the fraction of the last type varies fastest
+ * \note the search is O(product of the fraction sizes), correlating the elements by equal keys is
+ *       find_first(hc, pa, pb, f) or join(hc, pa, pb), the hash join
+ */
+template<typename... Ts, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<Ts...> F>
+requires (sizeof...(Ts) > 1)
+constexpr auto find_first(hetero_container<InnerC, OuterC> const & hc, F && f) ->
+std::pair<bool, std::tuple<typename hetero_container<InnerC, OuterC>::template inner_iterator<Ts>...>> {
+  std::tuple<typename hetero_container<InnerC, OuterC>::template inner_iterator<Ts>...> iterators;
+  auto fractions = std::make_tuple(hc.template find_fraction<Ts>()...);
+  auto present = std::apply([](auto const *... fr) { return (... && (fr != nullptr)); }, fractions);
+  return std::pair{present && details::nested_find<0>(fractions, iterators, f), iterators};
+}
+
+/**
+ * \brief Finds the first pair of the elements of the types A and B having equal keys and matched against predicate F
+ * \param pa projection of the A elements to the key, pointer to the data member or to the getter
+ * \param pb projection of the B elements to the key, the keys are hashable and comparable for equality
+ * \param f match predicate of the pair, f(A const &, B const &)
+ * \return pair of presence flag and tuple of the iterators to the elements, the first pair in the order of A then B
+ * \details hash join: the A fraction is probed against the hash table of B keys, the hash index of B by pb
+ *          serves it if there is one (see create_index()), the predicate is checked for the pairs of equal keys only
+ */
+template<typename A, typename B, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, typename PA, typename PB, typename F>
+requires std::invocable<PA const &, A const &> && std::invocable<PB const &, B const &> && std::predicate<F &, A const &, B const &>
+auto find_first(hetero_container<InnerC, OuterC> const & hc, PA const & pa, PB const & pb, F && f) ->
+std::pair<bool, std::tuple<typename hetero_container<InnerC, OuterC>::template inner_iterator<A>, typename hetero_container<InnerC, OuterC>::template inner_iterator<B>>> {
+  std::tuple<typename hetero_container<InnerC, OuterC>::template inner_iterator<A>, typename hetero_container<InnerC, OuterC>::template inner_iterator<B>> found;
+  auto fa = hc.template find_fraction<A>();
+  auto fb = hc.template find_fraction<B>();
+  if(fa == nullptr || fb == nullptr) {
+    return std::pair{false, found};
+  }
+  details::offset_iterators a(*fa), b(*fb);
+  bool present = false;
+  hc.template join_offsets<A, B>(*fa, pa, *fb, pb, [&](std::size_t ia, std::size_t ib) {
+    if(f(*a[ia], *b[ib])) {
+      found = std::tuple{a[ia], b[ib]};
+      present = true;
+    }
+    return !present;
+  });
+  return std::pair{present, found};
+}
+
+/**
+ * \brief Hash join of the elements of the types A and B by equal keys, the pairs are matched against predicate F
+ * \param pa projection of the A elements to the key, pointer to the data member or to the getter
+ * \param pb projection of the B elements to the key, the keys are hashable and comparable for equality
+ * \param f match predicate of the pair, f(A const &, B const &), checked for the pairs of equal keys only
+ * \return pairs of the iterators to the matched elements in the order of A then B
+ * \details the hash table is built over the smaller fraction unless one of them has the hash index
+ *          by its projection (see create_index()), then the index serves as the table; the transient table
+ *          is allocated from the resource of the container. O(size of A + size of B + number of the pairs).
+ */
+template<typename A, typename B, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, typename PA, typename PB, typename F>
+requires std::invocable<PA const &, A const &> && std::invocable<PB const &, B const &> && std::predicate<F &, A const &, B const &>
+auto join(hetero_container<InnerC, OuterC> const & hc, PA const & pa, PB const & pb, F && f) ->
+std::vector<std::pair<typename hetero_container<InnerC, OuterC>::template inner_iterator<A>, typename hetero_container<InnerC, OuterC>::template inner_iterator<B>>> {
+  std::vector<std::pair<typename hetero_container<InnerC, OuterC>::template inner_iterator<A>, typename hetero_container<InnerC, OuterC>::template inner_iterator<B>>> pairs;
+  auto fa = hc.template find_fraction<A>();
+  auto fb = hc.template find_fraction<B>();
+  if(fa == nullptr || fb == nullptr) {
+    return pairs;
+  }
+  details::offset_iterators a(*fa), b(*fb);
+  auto build_a = hc.template find_index<details::hash_index, B>(pb) == nullptr &&
+                 (hc.template find_index<details::hash_index, A>(pa) != nullptr || std::size(*fa) < std::size(*fb));
+  if(!build_a) {
+    hc.template join_offsets<A, B>(*fa, pa, *fb, pb, [&](std::size_t ia, std::size_t ib) {
+      if(f(*a[ia], *b[ib])) {
+        pairs.emplace_back(a[ia], b[ib]);
+      }
+      return true;
+    });
+    return pairs;
+  }
+  // B is probed in order, the pairs are put in the order of A keeping the order of B
+  std::vector<std::pair<std::size_t, std::size_t>> offsets;
+  hc.template join_offsets<B, A>(*fb, pb, *fa, pa, [&](std::size_t ib, std::size_t ia) {
+    if(f(*a[ia], *b[ib])) {
+      offsets.emplace_back(ia, ib);
+    }
+    return true;
+  });
+  std::ranges::stable_sort(offsets, {}, &std::pair<std::size_t, std::size_t>::first);
+  pairs.reserve(offsets.size());
+  for(auto [ia, ib] : offsets) {
+    pairs.emplace_back(a[ia], b[ib]);
+  }
+  return pairs;
+}
+
+/// \brief Hash join of the elements of the types A and B by equal keys, see join(hc, pa, pb, f)
+template<typename A, typename B, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, typename PA, typename PB>
+requires std::invocable<PA const &, A const &> && std::invocable<PB const &, B const &>
+auto join(hetero_container<InnerC, OuterC> const & hc, PA const & pa, PB const & pb) {
+  return join<A, B>(hc, pa, pb, [](A const &, B const &) { return true; });
+}
+
 /**
  * \brief
  * \tparam T
@@ -518,9 +1753,8 @@ std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterat
 template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
 constexpr auto find_last(hetero_container<InnerC, OuterC> const & hc, F && f) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if (iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    return find_prev<T>(hc, iter->second.end(), f);
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    return find_prev<T>(hc, fr->end(), f);
   }
   return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
 }
@@ -528,13 +1762,10 @@ std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterat
 template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
 constexpr auto find_prev(hetero_container<InnerC, OuterC> const & hc, typename hetero_container<InnerC, OuterC>::template inner_iterator<T> pos, F && f) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if (iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    if(iter->second.end() != iter->second.begin()) {
-      for(auto e = std::prev(pos); e != iter->second.begin(); --e) {
-        if(std::forward<F>(f)(*e)) {
-          return std::pair{true, e};
-        }
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    while(pos != fr->begin()) {
+      if(std::forward<F>(f)(*--pos)) {
+        return std::pair{true, pos};
       }
     }
   }
@@ -549,14 +1780,23 @@ std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterat
  * \param output container to place result set
  * \param f match predicate
  * \return false if result set is empty, true otherwise
+ * \note comparisons of arithmetic elements against constants, where(element() > 5), are evaluated by the vector
+ *       kernels into the match bitmap, see match_bitmap()
  */
 template <typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::output_iterator<T> O, std::invocable<T> F>
 constexpr bool find_all(hetero_container<InnerC, OuterC> const & hc, O output, F && f) {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if(iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    auto ce = iter->second.cend();
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    if constexpr(details::is_scannable_fraction<InnerC<T>, std::remove_cvref_t<F>>) {
+      if(auto p = details::scan_recognizer<T, std::remove_cvref_t<F>>::of(f); p) {
+        return details::scan_each(std::ranges::data(*fr), std::size(*fr), *p, [&output, &fr](std::size_t i) {
+          output = std::ranges::data(*fr)[i];
+          output++;
+        }) > 0;
+      }
+    }
+    auto ce = fr->cend();
     std::size_t copied = 0;
-    for(auto cb = iter->second.cbegin(); cb != ce; ++cb) {
+    for(auto cb = fr->cbegin(); cb != ce; ++cb) {
       if(std::forward<F>(f)(*cb)) {
         output = *cb;
         output++;
@@ -568,6 +1808,110 @@ constexpr bool find_all(hetero_container<InnerC, OuterC> const & hc, O output, F
   return false;
 }
 
+/**
+ * \brief Finds all elements of the type T matched to predicate F on the scheduler of the policy
+ * \param hc container to search
+ * \param policy scheduler and chunk size; the matches of every chunk are collected into the buffer of the chunk,
+ *        the chunks are coarsened so there are at most details::chunks_per_thread of them per thread,
+ *        policy.ordered merges the buffers into the output in the fraction order once all the chunks are done,
+ *        otherwise every chunk flushes its buffer into the output as soon as it's done
+ * \param output container to place result set, it's written by a single thread at a time
+ * \param f match predicate, invoked concurrently
+ * \return false if result set is empty, true otherwise
+ * \note fractions of the containers without random access are searched sequentially
+ */
+template <typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::output_iterator<T> O, std::invocable<T> F>
+bool find_all(hetero_container<InnerC, OuterC> const & hc, parallel_policy const & policy, O output, F && f) {
+  if constexpr(!std::random_access_iterator<typename InnerC<T>::iterator>) {
+    return find_all<T>(hc, std::move(output), std::forward<F>(f));
+  } else {
+    auto fr = hc.template find_fraction<T>();
+    if(fr == nullptr) {
+      return false;
+    }
+    auto size = std::size(*fr);
+    // the chunks are coarsened to at most chunks_per_thread per thread, so the buffers stay few for a small grain
+    auto grain = std::max({policy.grain, std::size_t{1}, size / (policy.executor().concurrency() * details::chunks_per_thread) + 1});
+    std::vector<std::vector<std::size_t>> buffers(size / grain + (size % grain != 0));
+    std::mutex output_mutex;
+    std::size_t found = 0;
+    auto flush = [&output, &found, first = std::begin(*fr)](std::vector<std::size_t> & offsets) {
+      for(auto offset : offsets) {
+        output = first[offset];
+        output++;
+      }
+      found += offsets.size();
+      offsets = {};
+    };
+    details::cancellation cancel;
+    details::run_parallel(policy, buffers.size(), [&](std::size_t chunk) {
+      auto & offsets = buffers[chunk];
+      details::match_offsets(*fr, chunk * grain, chunk * grain + std::min(grain, size - chunk * grain), f, offsets);
+      if(!policy.ordered && !offsets.empty()) {
+        std::lock_guard lock(output_mutex);
+        flush(offsets);
+      }
+    }, cancel);
+    if(policy.ordered) {
+      for(auto & offsets : buffers) {
+        flush(offsets);
+      }
+    }
+    return found > 0;
+  }
+}
+
+/**
+ * \brief Counts the elements of the type T matched to predicate F without materializing them
+ * \note comparisons of arithmetic elements against constants are counted on the match bitmap of the vector kernels
+ */
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
+auto count_if(hetero_container<InnerC, OuterC> const & hc, F && f) -> std::size_t {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    return details::count_matches(*fr, 0, std::size(*fr), f);
+  }
+  return 0;
+}
+
+/**
+ * \brief Counts the elements of the type T matched to predicate F on the scheduler of the policy
+ * \note predicate is invoked concurrently; fractions of the containers without random access are counted sequentially
+ */
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
+auto count_if(hetero_container<InnerC, OuterC> const & hc, parallel_policy const & policy, F && f) -> std::size_t {
+  if constexpr(!std::random_access_iterator<typename InnerC<T>::iterator>) {
+    return count_if<T>(hc, std::forward<F>(f));
+  } else {
+    auto fr = hc.template find_fraction<T>();
+    if(fr == nullptr) {
+      return 0;
+    }
+    std::atomic<std::size_t> count{0};
+    policy.executor().parallel_for(0, std::size(*fr), policy.grain, [&](std::size_t first, std::size_t last) {
+      count.fetch_add(details::count_matches(*fr, first, last, f), std::memory_order_relaxed);
+    });
+    return count.load();
+  }
+}
+
+/**
+ * \brief Builds the bitmap of the elements of the type T matched to predicate F
+ * \param hc container to search
+ * \param f match predicate
+ * \return bitmap of (size + 63) / 64 words, bit i % 64 of the word i / 64 is set if the element i matches
+ * \note the bitmap is built by the vector kernels (AVX2 or SSE2, picked at runtime) for the comparisons
+ *       of arithmetic elements against constants, by calling the predicate per element otherwise
+ */
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, std::invocable<T> F>
+auto match_bitmap(hetero_container<InnerC, OuterC> const & hc, F const & f) -> std::vector<std::uint64_t> {
+  std::vector<std::uint64_t> bits;
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    bits.resize((std::size(*fr) + 63) / 64);
+    details::scan_bitmap(*fr, f, bits.data());
+  }
+  return bits;
+}
+
 /**
  * \brief
  * \tparam T
@@ -581,8 +1925,14 @@ constexpr bool find_all(hetero_container<InnerC, OuterC> const & hc, O output, F
 template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, projection_clause Clause, projection_clause... Clauses>
 constexpr auto query_first(hetero_container<InnerC, OuterC> const & hc, Clause && clause, Clauses &&... clauses) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    auto matches = [&](T const & e) { return clause_matches(clause, e) && (... && clause_matches(clauses, e)); };
+    if(auto offset = hc.template indexed_query<T, false>(*fr, matches, clause, clauses...); offset) {
+      return *offset < std::size(*fr) ? std::pair{true, std::next(fr->begin(), *offset)} : std::pair{false, fr->end()};
+    }
+  }
   return query_first_if<T>(hc, []<typename C, typename Obj>(C && c, Obj const & obj) {
-    return std::invoke(c.first, obj) == c.second; //  simplest case is obj.prj == arg
+    return clause_matches(c, obj); //  simplest case is obj.prj == arg
   }, std::forward<Clause>(clause), std::forward<Clauses>(clauses)...);
 }
 
@@ -602,23 +1952,29 @@ template<typename T, template <typename...> class InnerC, template <typename, ty
 requires std::conjunction_v<std::is_invocable<F, Clause, T>, std::is_invocable<F, Clauses, T>...>
 constexpr auto query_first_if(hetero_container<InnerC, OuterC> const & hc, F && f, Clause && clause, Clauses &&... clauses) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if (iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    for(auto it = iter->second.begin(); it != iter->second.end(); ++it) {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    for(auto it = fr->begin(); it != fr->end(); ++it) {
       if(std::forward<F>(f)(std::forward<Clause>(clause), *it) &&
          (... && std::forward<F>(f)(std::forward<Clauses>(clauses), *it))) {
         return std::pair{true, it};
       }
     }
+    return std::pair{false, fr->end()};
   }
-  return std::pair{false, iter->second.end()};
+  return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
 }
 
 template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, projection_clause Clause, projection_clause... Clauses>
 constexpr auto query_last(hetero_container<InnerC, OuterC> const & hc, Clause && clause, Clauses &&... clauses) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    auto matches = [&](T const & e) { return clause_matches(clause, e) && (... && clause_matches(clauses, e)); };
+    if(auto offset = hc.template indexed_query<T, true>(*fr, matches, clause, clauses...); offset) {
+      return *offset < std::size(*fr) ? std::pair{true, std::next(fr->begin(), *offset)} : std::pair{false, fr->end()};
+    }
+  }
   return query_last_if<T>(hc, []<typename C, typename Obj>(C && c, Obj const & obj) {
-    return std::invoke(c.first, obj) == c.second;
+    return clause_matches(c, obj);
   }, std::forward<Clause>(clause), std::forward<Clauses>(clauses)...);
 }
 
@@ -626,18 +1982,103 @@ template<typename T, template <typename...> class InnerC, template <typename, ty
 requires std::conjunction_v<std::is_invocable<F, Clause, T>, std::is_invocable<F, Clauses, T>...>
 constexpr auto query_last_if(hetero_container<InnerC, OuterC> const & hc, F && f, Clause && clause, Clauses &&... clauses) ->
 std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
-  auto iter = hetero_container<InnerC, OuterC>::template _items<T>.find(&hc);
-  if (iter != hetero_container<InnerC, OuterC>::template _items<T>.cend()) {
-    if(iter->second.end() != iter->second.begin()) {
-      for(auto e = std::prev(iter->second.end()); e != iter->second.begin(); --e) {
-        if(std::forward<F>(f)(std::forward<Clause>(clause), *e) &&
-           (... && std::forward<F>(f)(std::forward<Clauses>(clauses), *e))) {
-          return std::pair{true, e};
-        }
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    for(auto e = fr->end(); e != fr->begin();) {
+      --e;
+      if(std::forward<F>(f)(std::forward<Clause>(clause), *e) &&
+         (... && std::forward<F>(f)(std::forward<Clauses>(clauses), *e))) {
+        return std::pair{true, e};
+      }
+    }
+    return std::pair{false, fr->end()};
+  }
+  return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
+}
+
+/**
+ * \brief Finds the first element of the type T satisfying the query expression
+ * \param hc container to search
+ * \param expression query expression, see where() and field()
+ * \return pair of presence flag and iterator
+ * \note comparisons of the top-level conjunction are looked up through the indexes, see create_index()
+ */
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, query_expression E>
+constexpr auto query_first(hetero_container<InnerC, OuterC> const & hc, E const & expression) ->
+std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    auto offset = std::apply([&](auto const &... clauses) {
+      return hc.template indexed_query<T, false>(*fr, expression, clauses...);
+    }, expression.clauses());
+    if(offset) {
+      return *offset < std::size(*fr) ? std::pair{true, std::next(fr->begin(), *offset)} : std::pair{false, fr->end()};
+    }
+    if(offset = details::scan_first(*fr, expression); offset) {
+      return *offset < std::size(*fr) ? std::pair{true, std::next(fr->begin(), *offset)} : std::pair{false, fr->end()};
+    }
+    auto found = std::find_if(fr->begin(), fr->end(), expression);
+    return std::pair{found != fr->end(), found};
+  }
+  return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
+}
+
+/// \brief Finds the last element of the type T satisfying the query expression, see query_first(hc, expression)
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, query_expression E>
+constexpr auto query_last(hetero_container<InnerC, OuterC> const & hc, E const & expression) ->
+std::pair<bool, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>> {
+  if(auto fr = hc.template find_fraction<T>(); fr != nullptr) {
+    auto offset = std::apply([&](auto const &... clauses) {
+      return hc.template indexed_query<T, true>(*fr, expression, clauses...);
+    }, expression.clauses());
+    if(offset) {
+      return *offset < std::size(*fr) ? std::pair{true, std::next(fr->begin(), *offset)} : std::pair{false, fr->end()};
+    }
+    for(auto e = fr->end(); e != fr->begin();) {
+      if(expression(*--e)) {
+        return std::pair{true, e};
       }
     }
+    return std::pair{false, fr->end()};
+  }
+  return std::pair{false, typename hetero_container<InnerC, OuterC>::template inner_iterator<T>{}};
+}
+
+/**
+ * \brief Looks up the elements of the type T matching the range clause through the ordered index
+ * \tparam T type of the elements
+ * \param hc container to search
+ * \param clause range clause, see lt(), le(), gt(), ge() and between(), or equality clause
+ * \return range of the elements in the order of their projections, elements of equal projections go in the fraction order
+ * \throw std::logic_error if there is no ordered index of the type T elements by the projection, see create_ordered_index()
+ * \attention the range is invalidated by structural changes of the fraction
+ */
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, projection_clause Clause>
+auto query_range(hetero_container<InnerC, OuterC> const & hc, Clause const & clause) {
+  using P = std::remove_cvref_t<decltype(clause.first)>;
+  using V = std::remove_cvref_t<decltype(clause.second)>;
+  auto idx = hc.template find_index<details::ordered_index, T>(clause.first);
+  if(idx == nullptr) {
+    throw std::logic_error("no ordered index by the projection, see create_ordered_index()");
   }
-  return std::pair{false, iter->second.end()};
+  auto range = [&] {
+    if constexpr(is_bounds<V>) {
+      return idx->range(clause.second);
+    } else {
+      return idx->range(bounds<V>{clause.second, clause.second});
+    }
+  }();
+  return range | std::views::transform([fr = hc.template find_fraction<T>()](
+      typename details::ordered_index<T, InnerC<T>, P>::entry const & e) -> T const & {
+    return *std::next(std::begin(*fr), e.offset);
+  });
+}
+
+/**
+ * \brief Looks up the elements of the type T whose projection lies within [lo, hi] through the ordered index
+ * \see query_range(hc, clause)
+ */
+template<typename T, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC, typename P, typename V>
+auto query_range(hetero_container<InnerC, OuterC> const & hc, P projection, V lo, V hi) {
+  return query_range<T>(hc, between(projection, std::move(lo), std::move(hi)));
 }
 
 template <typename... Ts, template <typename...> class InnerC, template <typename, typename, typename...> class OuterC>
@@ -656,9 +2097,20 @@ auto to_tuple(hetero_container<InnerC, OuterC> && hv) -> std::tuple<safe_ref<Ts>
 }
 
 template <template <typename...> class C> using hash_key_container = hetero_container<C, std::unordered_map>;
+template <template <typename...> class C> using indexed_container = hetero_container<C, indexed_storage>;
+template <template <typename...> class C> using concurrent_key_container = hetero_container<C, sharded_map>;
+
+using hvector = indexed_container<std::vector>;
+using hdeque = indexed_container<std::deque>;
+
+using pmr_hvector = indexed_container<std::pmr::vector>;
+using pmr_hdeque = indexed_container<std::pmr::deque>;
+
+/// \brief Indexed container keeping up to N elements of every type inline, i.e. one allocation per type
+template <std::size_t N = 4> using hsmall_vector = indexed_container<small_vector_n<N>::template type>;
 
-using hvector = hash_key_container<std::vector>;
-using hdeque = hash_key_container<std::deque>;
+/// \brief Indexed container addressing elements by stable keys, erasure is O(1) and reorders elements
+using hslot_map = indexed_container<slot_map>;
 
 } // namespace het
 
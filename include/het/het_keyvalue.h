@@ -10,10 +10,15 @@
 #include <tuple>
 #include <functional>
 #include <unordered_map>
+#include <memory>
+#include <memory_resource>
 
 #include "details/expected.h"
 #include "details/error.h"
 #include "details/typesafe.h"
+#include "details/sharded_map.h"
+#include "details/memory_usage.h"
+#include "details/parallel.h"
 
 namespace het {
 
@@ -24,21 +29,34 @@ using namespace metaf::util;
 
 template <template <typename, typename, typename...> class C>
 class hetero_key_value {
-  template <typename K, typename T> static C<hetero_key_value const *, C<K, T>> _values;
+  template <typename K, typename T> static C<hetero_key_value const *, owner_map_t<C, K, T>> _values;
   template <typename K, typename T> requires is_suitable_container<hetero_key_value const *, T, C> && is_suitable_container<K, T, C>
-  static consteval C<hetero_key_value const *, C<K, T>> & values() {
+  static consteval C<hetero_key_value const *, owner_map_t<C, K, T>> & values() {
     return _values<K, T>;
   }
 
 public:
   hetero_key_value() = default;
+  /**
+   * \brief Creates empty object keeping its bookkeeping and allocator-aware per-owner maps in the memory resource
+   * \param resource memory resource, must outlive the object
+   * \note per-owner maps are allocator-aware with the pmr_owner_registry policy (pmr_hkeyvalue),
+   *       registry nodes are allocated by the registry allocator
+   */
+  explicit hetero_key_value(std::pmr::memory_resource * resource) noexcept : _resource(resource) {}
   hetero_key_value(hetero_key_value const & value) {
     assign(value);
   }
-  hetero_key_value(hetero_key_value && value) noexcept {
+  /// \brief Takes over key-value maps along with the memory resource, may throw what re-keying the registry nodes throws
+  hetero_key_value(hetero_key_value && value) : _resource(value._resource) {
     assign(std::move(value));
   }
-  template <typename... Ts> explicit hetero_key_value(Ts &&... ts) {
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_key_value> && ...)
+  explicit hetero_key_value(Ts &&... ts) {
+    (add_value(std::forward<Ts>(ts)), ...);
+  }
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_key_value> && ...)
+  hetero_key_value(std::allocator_arg_t, std::pmr::memory_resource * resource, Ts &&... ts) : _resource(resource) {
     (add_value(std::forward<Ts>(ts)), ...);
   }
 
@@ -51,22 +69,66 @@ public:
     return *this;
   }
 
-  hetero_key_value & operator=(hetero_key_value && value) noexcept {
+  hetero_key_value & operator=(hetero_key_value && value) {
     assign(std::move(value));
     return *this;
   }
 
   void assign(hetero_key_value const & value) {
+    if(&value == this) {
+      return;
+    }
     clear();
-    _clear_functions = value._clear_functions;
-    _copy_functions = value._copy_functions;
-    for (auto && copy : _copy_functions) {
-      copy(value, *this);
+    _ops = value._ops;
+    for (auto && ops : _ops) {
+      ops->copy(value, *this);
+    }
+    _size = value._size;
+  }
+
+  /**
+   * \brief Takes over key-value maps of the other object without touching their elements
+   * \param value object to move from, it's left empty
+   * \note costs O(number of key-value types), each map node is re-keyed in its registry
+   * \attention memory resources are not propagated, if they differ allocator-aware maps are moved element-wise
+   * \throw what the allocation of the moved maps throws when the resources differ
+   */
+  void assign(hetero_key_value && value) {
+    if(&value == this) {
+      return;
     }
+    clear();
+    // the operations are taken first, so that clear() finds the maps moved so far if a move throws
+    _ops = value._ops;
+    _size = value._size;
+    try {
+      for (auto && ops : value._ops) {
+        ops->move(value, *this);
+      }
+    } catch(...) {
+      clear(); // releases the maps moved so far, the other object keeps the rest
+      throw;
+    }
+    if(same_resource(value)) {
+      value._ops.clear();
+      value._size = 0;
+    } else {
+      value.clear(); // releases what is left of the moved maps
+    }
+  }
+
+  void swap(hetero_key_value & value) {
+    hetero_key_value tmp(std::move(value));
+    value.assign(std::move(*this));
+    assign(std::move(tmp));
+  }
+
+  friend void swap(hetero_key_value & lhs, hetero_key_value & rhs) {
+    lhs.swap(rhs);
   }
 
-  void assign(hetero_key_value && value) noexcept {
-    assign(static_cast<hetero_key_value const &>(value));
+  [[nodiscard]] std::pmr::memory_resource * resource() const noexcept {
+    return _resource;
   }
 
   template <typename... Ts> void assign_values(Ts const &... values) {
@@ -154,27 +216,55 @@ public:
   template <typename T, typename K> bool erase_value(K && key) {
     auto & vs = hetero_key_value::values<K, T>();
     if(auto c = vs.find(this); c != std::end(vs)) {
-      return c->second.erase(std::forward<K>(key));
+      auto erased = c->second.erase(std::forward<K>(key));
+      _size -= erased;
+      return erased > 0;
     }
     return false;
   }
 
   void clear() {
-    for (auto && clear_function : _clear_functions) {
-      clear_function(*this);
+    for (auto && ops : _ops) {
+      ops->release(*this);
     }
+    _ops.clear();
+    _size = 0;
   }
 
-  [[nodiscard]] bool empty() const {
-    return size() == 0;
+  [[nodiscard]] bool empty() const noexcept {
+    return _size == 0;
   }
 
-  [[nodiscard]] std::size_t size() const {
-    std::size_t sz = 0;
-    for (auto && size_function : _size_functions) {
-      sz += size_function(*this);
+  /// \brief Returns the number of key-value pairs of all the types, the count is kept by the object
+  [[nodiscard]] std::size_t size() const noexcept {
+    return _size;
+  }
+
+  /**
+   * \brief Reports memory used by the object, in total and per key and value types pair
+   * \return memory report, types are listed in order of registration
+   * \note the object footprint itself is not included, neither are the registry buckets shared
+   *       by all the objects, see registry_stats()
+   */
+  [[nodiscard]] memory_report memory_usage() const {
+    memory_report r;
+    r.types.reserve(_ops.size());
+    for (auto && ops : _ops) {
+      r.types.push_back(ops->usage(*this));
+      r.total += r.types.back().usage;
     }
-    return sz;
+    r.total.bookkeeping_bytes += _ops.capacity() * sizeof(values_ops const *);
+    return r;
+  }
+
+  /**
+   * \brief Reports the process-wide registry of the key-value maps of K and T types
+   * \tparam K key type
+   * \tparam T value type
+   * \return size, bucket count and load factor of the registry
+   */
+  template <typename K, typename T> [[nodiscard]] static registry_statistics registry_stats() {
+    return details::statistics_of(hetero_key_value::values<K, T>());
   }
 
   template <typename K, typename... Ts> requires (sizeof...(Ts) > 0)
@@ -192,6 +282,48 @@ public:
     };
   }
 
+  /**
+   * \brief Generates key-value accessor for Ts... types running the visitor F on the threads of the policy
+   * \tparam K key type
+   * \tparam Ts value types to proceed
+   * \param policy scheduler and chunk size, maps of different types and chunks of grain pairs of a map run concurrently
+   * \return function which applies visitor F(key, value), Break returned by F cancels the run cooperatively
+   * \note visitor is invoked concurrently, it has to be thread safe; the pairs are visited in no particular order
+   */
+  template <typename K, typename... Ts> requires (sizeof...(Ts) > 0)
+  [[nodiscard]] auto visit_par(parallel_policy policy = {}) const {
+    return [this, policy]<typename F>(F && f) -> VisitorReturn {
+      static_assert((std::is_invocable_v<F, K, Ts> && ...), "predicate should accept provided types");
+      details::cancellation cancel;
+      for_each_par<K, Ts...>(policy, cancel, [&f, &cancel](auto const & key, auto & value) {
+        if(f(key, value) == VisitorReturn::Break) {
+          cancel.request();
+        }
+      });
+      return cancel.requested() ? VisitorReturn::Break : VisitorReturn::Continue;
+    };
+  }
+
+  /**
+   * \brief Generates key-value accessor for Ts... types running the predicates on the threads of the policy
+   * \return function which applies the predicate applicable to (K, T) on the pairs of the type T,
+   *         true if the maps of all the types are present
+   */
+  template <typename K, typename... Ts> requires (sizeof...(Ts) > 0)
+  [[nodiscard]] auto match_par(parallel_policy policy = {}) const {
+    return [this, policy]<typename... Fs>(Fs &&... fs) -> bool {
+      details::cancellation cancel;
+      for_each_par<K, Ts...>(policy, cancel, [&fs...]<typename V>(auto const & key, V & value) {
+        stg::util::fn_select_applicable<K, std::remove_cvref_t<V>>::check(fs...)(key, value);
+      });
+      auto present = [this]<typename T>(std::type_identity<T>) {
+        auto & vs = hetero_key_value::values<K, T>();
+        return vs.find(this) != std::end(vs);
+      };
+      return (present(std::type_identity<Ts>{}) && ...);
+    };
+  }
+
   template <typename... Ts, typename K>
   auto to_tuple(K && key) const -> std::tuple<safe_ref<Ts>...> {
     if(!(contains<safe_ref<Ts>>(std::forward<K>(key)) && ...)) {
@@ -225,6 +357,39 @@ public:
   }
 
 private:
+  /**
+   * \brief Applies the function to the key-value pairs of the Ts... maps on the scheduler of the policy
+   * \details maps are split into chunks of policy.grain pairs by walking them once, the workers stop taking
+   * pairs once the cancellation is requested
+   */
+  template <typename K, typename... Ts, typename Fn>
+  void for_each_par(parallel_policy const & policy, details::cancellation & cancel, Fn const & fn) const {
+    auto bounds = std::make_tuple([this, &policy]<typename T>(std::type_identity<T>) {
+      auto & vs = hetero_key_value::values<K, T>();
+      auto it = vs.find(this);
+      using map_type = std::remove_reference_t<decltype(it->second)>;
+      return it != std::end(vs) ? details::chunk_bounds(it->second, policy.grain) : std::vector<typename map_type::iterator>{};
+    }(std::type_identity<Ts>{})...);
+    std::vector<details::fraction_chunk> chunks;
+    [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      ([&](auto const & b) {
+        for(std::size_t i = 0; i + 1 < b.size(); ++i) {
+          chunks.push_back({Is, i, i + 1});
+        }
+      }(std::get<Is>(bounds)), ...);
+    }(std::index_sequence_for<Ts...>{});
+    details::run_parallel(policy, chunks.size(), [&](std::size_t i) {
+      auto const & chunk = chunks[i];
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        ((chunk.type == Is ? ([&](auto const & b) {
+          for(auto it = b[chunk.first]; it != b[chunk.last] && !cancel.requested(); ++it) {
+            fn(it->first, it->second);
+          }
+        }(std::get<Is>(bounds)), true) : false) || ...);
+      }(std::index_sequence_for<Ts...>{});
+    }, cancel);
+  }
+
   template <typename K, typename T, typename... Fs> constexpr bool match_single(Fs &&... fs) const {
     auto f = stg::util::fn_select_applicable<K, T>::check(std::forward<Fs>(fs)...);
     auto & vs = hetero_key_value::values<K, T>();
@@ -250,53 +415,110 @@ private:
     return VisitorReturn::Continue;
   }
 
-  template <typename T> auto add_value(T && value) -> typename C<typename T::first_type, typename T::second_type>::iterator {
-    return add_value(std::forward<T>(value).first, std::move(std::forward<T>(value).second)); // typename C<K, T>::iterator
+  template <typename T> auto add_value(T && value) -> typename owner_map_t<C, typename T::first_type, typename T::second_type>::iterator {
+    return add_value(std::forward<T>(value).first, std::move(std::forward<T>(value).second));
   }
 
-  template <typename K, typename T> auto add_value(K && key, T const & value) -> typename C<K, T>::iterator {
+  template <typename K, typename T> auto add_value(K && key, T const & value) -> typename owner_map_t<C, K, T>::iterator {
     return add_value(std::forward<K>(key), std::move(value));
   }
 
-  template <typename K, typename T> auto add_value(K && key, T & value) -> typename C<K, T>::iterator {
+  template <typename K, typename T> auto add_value(K && key, T & value) -> typename owner_map_t<C, K, T>::iterator {
     return add_value(std::forward<K>(key), std::move(value));
   }
 
-  template <typename K, typename T> auto add_value(K && key, T && value) -> typename C<K, T>::iterator {
+  template <typename K, typename T> auto add_value(K && key, T && value) -> typename owner_map_t<C, K, T>::iterator {
     register_operations<K, T>(); // ensures new values<K,T> functions added
+    auto [it, inserted] = owner_values<K, T>().insert_or_assign(std::forward<K>(key), std::forward<T>(value)); // ensures new values<K,T> entry added
+    _size += inserted ? 1 : 0;
+    return it;
+  }
+
+  // inserts new per-owner map or access existing, allocator-aware map is built by the memory resource of the object
+  template <typename K, typename T> auto owner_values() -> owner_map_t<C, K, T> & {
     auto & vs = hetero_key_value::values<K, T>();
-    return vs[this].insert_or_assign(std::forward<K>(key), std::forward<T>(value)).first; // ensures new values<K,T> entry added
+    if constexpr(std::uses_allocator_v<owner_map_t<C, K, T>, std::pmr::polymorphic_allocator<>>) {
+      return vs.try_emplace(this, typename owner_map_t<C, K, T>::allocator_type(_resource)).first->second;
+    } else {
+      return vs[this];
+    }
   }
 
-  template<typename K, typename T> auto register_operations() -> typename C<hetero_key_value const *, C<K, T>>::iterator {
+  template<typename K, typename T> auto register_operations() -> typename C<hetero_key_value const *, owner_map_t<C, K, T>>::iterator {
     auto & vs = hetero_key_value::values<K, T>();
-    // don't have it yet, so create functions for copying and destroying
+    // don't have it yet, so register operations for copying, moving, destroying, etc
     auto it = vs.find(this);
     if (it == std::end(vs)) {
-      _clear_functions.template emplace_back([](hetero_key_value & c) { hetero_key_value::values<K, T>().erase(&c); });
-      // if someone copies me, they need to call each copy_function and pass themself
-      _copy_functions.template emplace_back([](const hetero_key_value & from, hetero_key_value & to) {
-        if(&from != &to) {
-          auto & vs = hetero_key_value::template values<K, T>();
-          if constexpr(std::is_copy_constructible_v<T>) {
-            vs.insert_or_assign(&to, vs.at(&from));
-          } else {
-            vs.insert_or_assign(&to, std::move(vs.at(&const_cast<hetero_key_value&>(from))));
-          }
-        }
-      });
-      _size_functions.emplace_back([](const hetero_key_value & c) { return hetero_key_value::values<K, T>().at(&c).size(); });
+      _ops.push_back(&ops_of<K, T>);
     }
     return it;
   }
 
-  std::vector<std::function<void(hetero_key_value &)>> _clear_functions;
-  std::vector<std::function<void(const hetero_key_value &, hetero_key_value &)>> _copy_functions;
-  std::vector<std::function<size_t(const hetero_key_value &)>> _size_functions;
+  template <typename K, typename T> void copy_values(hetero_key_value const & from) {
+    if(&from != this) {
+      auto & vs = hetero_key_value::template values<K, T>();
+      if constexpr(std::is_copy_constructible_v<T>) {
+        owner_values<K, T>() = vs.at(&from);
+      } else {
+        owner_values<K, T>() = std::move(vs.at(&from));
+      }
+    }
+  }
+
+  // re-keys the registry node of the key-value map, allocator-aware map of the foreign memory resource is moved instead
+  template <typename K, typename T> void move_values(hetero_key_value & from) {
+    auto & vs = hetero_key_value::template values<K, T>();
+    if(std::uses_allocator_v<owner_map_t<C, K, T>, std::pmr::polymorphic_allocator<>> && !same_resource(from)) {
+      if(auto it = vs.find(&from); it != std::end(vs)) {
+        owner_values<K, T>() = std::move(it->second);
+      }
+    } else if constexpr(requires { vs.extract(&from); }) {
+      if(auto node = vs.extract(&from); !node.empty()) {
+        node.key() = this;
+        vs.insert(std::move(node));
+      }
+    } else if(auto it = vs.find(&from); it != std::end(vs)) {
+      vs.insert_or_assign(this, std::move(it->second));
+      vs.erase(&from);
+    }
+  }
+
+  // the key-value map is kept by the registry node keyed by the object address
+  template <typename K, typename T> auto values_usage() const -> type_memory_usage {
+    auto & m = hetero_key_value::values<K, T>().at(this);
+    auto u = details::usage_of<typename owner_map_t<C, K, T>::value_type>(m);
+    u.bookkeeping_bytes += details::node_bytes<C<hetero_key_value const *, owner_map_t<C, K, T>>> - sizeof(m);
+    return {typeid(T), typeid(K), m.size(), u};
+  }
+
+  // type-erased operations over the key-value map of a single key and value types pair
+  struct values_ops {
+    void (*release)(hetero_key_value &);
+    void (*copy)(hetero_key_value const &, hetero_key_value &);
+    void (*move)(hetero_key_value &, hetero_key_value &);
+    type_memory_usage (*usage)(hetero_key_value const &);
+  };
+
+  template <typename K, typename T> static constexpr values_ops ops_of{
+    [](hetero_key_value & c) { hetero_key_value::values<K, T>().erase(&c); },
+    [](hetero_key_value const & from, hetero_key_value & to) { to.template copy_values<K, T>(from); },
+    [](hetero_key_value & from, hetero_key_value & to) { to.template move_values<K, T>(from); },
+    [](hetero_key_value const & c) -> type_memory_usage { return c.template values_usage<K, T>(); }
+  };
+
+  [[nodiscard]] bool same_resource(hetero_key_value const & other) const noexcept {
+    return _resource == other._resource || _resource->is_equal(*other._resource);
+  }
+
+  std::pmr::memory_resource * _resource = std::pmr::get_default_resource();
+  // operations of the registered types, in order of registration
+  std::pmr::vector<values_ops const *> _ops = std::pmr::vector<values_ops const *>(_resource);
+  // number of key-value pairs of all the types
+  std::size_t _size = 0;
 };
 
 template <template <typename, typename, typename...> typename C>
-template <typename K, typename T> C<hetero_key_value<C> const *, C<K, T>> hetero_key_value<C>::_values;
+template <typename K, typename T> C<hetero_key_value<C> const *, owner_map_t<C, K, T>> hetero_key_value<C>::_values;
 
 template <typename... Ts, typename K, template <typename, typename, typename...> class C>
 auto to_tuple(hetero_key_value<C> const & hkv, K && key) -> std::tuple<safe_ref<Ts>...> {
@@ -358,7 +580,20 @@ auto try_to_vector(hetero_key_value<C> && hkv, Ks &&... keys) -> expected<std::v
   return hkv.template try_to_vector<T>(std::forward<Ks>(keys)...);
 }
 
+/**
+ * \brief Registry policy of hetero_key_value with allocator-aware per-owner maps
+ * \details the registry itself stays on the global heap, but every per-owner map and its values
+ * draw from the memory resource of the owner object
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+struct pmr_owner_registry : std::unordered_map<K, V, Hash, KeyEqual> {
+  using std::unordered_map<K, V, Hash, KeyEqual>::unordered_map;
+  using owner_map_type = std::pmr::unordered_map<K, V, Hash, KeyEqual>;
+};
+
 using hkeyvalue = hetero_key_value<std::unordered_map>;
+using pmr_hkeyvalue = hetero_key_value<pmr_owner_registry>;
+using concurrent_hkeyvalue = hetero_key_value<sharded_map>;
 
 } // namespace het
 
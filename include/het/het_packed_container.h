@@ -0,0 +1,493 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_HET_PACKED_CONTAINER_H
+#define HETLIB_HET_PACKED_CONTAINER_H
+
+#include "details/domains.h"
+#include "details/expected.h"
+#include "details/error.h"
+#include "details/typesafe.h"
+#include "details/type_list.h"
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <span>
+
+#include <tuple>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace het {
+
+using tl::expected;
+using tl::make_unexpected;
+
+using namespace metaf::util;
+
+/**
+ * \brief Heterogeneous container with the closed set of trivially copyable types Ts..., all the fractions
+ * are segments of the single aligned buffer laid out in the order of Ts...
+ * \tparam Ts types of the elements, every type is resolved at compile time
+ * \details Copying is a single memcpy of the used part of the buffer, clearing is a single deallocation,
+ * visiting sweeps the buffer linearly. Growing a segment reallocates the buffer, so pointers, references
+ * and spans to elements of any type are invalidated by an insertion which exceeds the segment capacity.
+ */
+template <typename... Ts> requires (sizeof...(Ts) > 0 && details::is_unique<Ts...> && (std::is_trivially_copyable_v<Ts> && ...))
+class packed_hetero_container {
+  template <typename T> static constexpr bool is_member = details::is_one_of<T, Ts...>;
+  template <typename T> static constexpr std::size_t index = details::index_of<T, Ts...>();
+
+  static constexpr std::size_t types_count = sizeof...(Ts);
+  static constexpr std::size_t alignment = std::max({alignof(Ts)...});
+  static constexpr std::array<std::size_t, types_count> type_sizes{sizeof(Ts)...};
+  static constexpr std::array<std::size_t, types_count> type_alignments{alignof(Ts)...};
+
+  using counts = std::array<std::size_t, types_count>;
+
+public:
+  packed_hetero_container() = default;
+
+  /**
+   * \brief Creates empty container allocating its buffer from the memory resource
+   * \param resource memory resource, must outlive the container
+   */
+  explicit packed_hetero_container(std::pmr::memory_resource * resource) noexcept : _resource(resource) {}
+
+  /// \brief Copies elements by a single memcpy, the copy uses the default memory resource like std::pmr containers do
+  packed_hetero_container(packed_hetero_container const & other) {
+    assign(other);
+  }
+
+  packed_hetero_container(packed_hetero_container const & other, std::pmr::memory_resource * resource) : _resource(resource) {
+    assign(other);
+  }
+
+  /// \brief Takes over the buffer along with the memory resource of the other container
+  packed_hetero_container(packed_hetero_container && other) noexcept : _resource(other._resource) {
+    assign(std::move(other));
+  }
+
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<std::remove_cvref_t<Us>> && ...))
+  explicit packed_hetero_container(Us &&... us) {
+    reserve_counts(counts_of<std::remove_cvref_t<Us>...>());
+    (push_back_single<std::remove_cvref_t<Us>>(us), ...);
+  }
+
+  ~packed_hetero_container() {
+    deallocate();
+  }
+
+  packed_hetero_container & operator=(packed_hetero_container const & other) {
+    assign(other);
+    return *this;
+  }
+
+  packed_hetero_container & operator=(packed_hetero_container && other) {
+    assign(std::move(other));
+    return *this;
+  }
+
+  void assign(packed_hetero_container const & other) {
+    if(&other == this) {
+      return;
+    }
+    // the copy is made aside, the container is left intact if the buffer can't be allocated
+    std::byte * data = nullptr;
+    if(other._data != nullptr) {
+      data = allocate(other._bytes);
+      std::memcpy(data, other._data, other.used_bytes());
+    }
+    deallocate();
+    _data = data;
+    _bytes = other._bytes;
+    _offset = other._offset;
+    _capacity = other._capacity;
+    _size = other._size;
+  }
+
+  /**
+   * \brief Takes over the buffer of the other container
+   * \param other container to move from, it's left empty
+   * \attention memory resources are not propagated, if they differ the buffer is copied
+   * \throw std::bad_alloc if the resources differ and the copy of the buffer can't be allocated
+   */
+  void assign(packed_hetero_container && other) {
+    if(&other == this) {
+      return;
+    }
+    if(!same_resource(other)) {
+      assign(other);
+      other.clear();
+      return;
+    }
+    deallocate();
+    _data = std::exchange(other._data, nullptr);
+    _bytes = std::exchange(other._bytes, 0);
+    _offset = std::exchange(other._offset, counts{});
+    _capacity = std::exchange(other._capacity, counts{});
+    _size = std::exchange(other._size, counts{});
+  }
+
+  void swap(packed_hetero_container & other) {
+    if(same_resource(other)) {
+      std::swap(_data, other._data);
+      std::swap(_bytes, other._bytes);
+      std::swap(_offset, other._offset);
+      std::swap(_capacity, other._capacity);
+      std::swap(_size, other._size);
+    } else {
+      packed_hetero_container tmp(std::move(other));
+      other.assign(std::move(*this));
+      assign(std::move(tmp));
+    }
+  }
+
+  friend void swap(packed_hetero_container & lhs, packed_hetero_container & rhs) {
+    lhs.swap(rhs);
+  }
+
+  [[nodiscard]] std::pmr::memory_resource * resource() const noexcept {
+    return _resource;
+  }
+
+  template <typename T, typename... Args> requires is_member<T> T & emplace_front(Args &&... args) {
+    return push_front_single<T>(T(std::forward<Args>(args)...));
+  }
+
+  template <typename T, typename... Args> requires is_member<T> T & emplace_back(Args &&... args) {
+    return push_back_single<T>(T(std::forward<Args>(args)...));
+  }
+
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<std::remove_cvref_t<Us>> && ...))
+  void push_front(Us &&... us) {
+    (push_front_single<std::remove_cvref_t<Us>>(us), ...);
+  }
+
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<std::remove_cvref_t<Us>> && ...))
+  void push_back(Us &&... us) {
+    (push_back_single<std::remove_cvref_t<Us>>(us), ...);
+  }
+
+  /// \brief Erases the first element of the type T, throws std::out_of_range if there is none
+  template <typename T> requires is_member<T> void pop_front() {
+    erase_at<T>(0);
+  }
+
+  /// \brief Erases the last element of the type T, throws std::out_of_range if there is none
+  template <typename T> requires is_member<T> void pop_back() {
+    if(count_of<T>() == 0) {
+      throw std::out_of_range(access_error_code(access::error_code::ValueNotFound).message());
+    }
+    --_size[index<T>];
+  }
+
+  /// \brief Erases the element of the type T at the index, throws std::out_of_range if the index is out of bounds
+  template <typename T> requires is_member<T> void erase(std::size_t index) {
+    erase_at<T>(index);
+  }
+
+  template <std::equality_comparable T> requires is_member<T> bool erase(T const & e) {
+    auto f = fraction<T>();
+    if(auto it = std::find(f.begin(), f.end(), e); it != f.end()) {
+      erase_at<T>(static_cast<std::size_t>(it - f.begin()));
+      return true;
+    }
+    return false;
+  }
+
+  template <typename T> requires is_member<T> T & at(std::size_t index) {
+    if(index >= count_of<T>()) {
+      throw std::out_of_range(access_error_code(access::error_code::ValueNotFound).message());
+    }
+    return segment<T>()[index];
+  }
+
+  template <typename T> requires is_member<T> T const & at(std::size_t index) const {
+    if(index >= count_of<T>()) {
+      throw std::out_of_range(access_error_code(access::error_code::ValueNotFound).message());
+    }
+    return segment<T>()[index];
+  }
+
+  /// \brief Removes all the elements releasing the buffer by a single deallocation
+  void clear() {
+    deallocate();
+    _bytes = 0;
+    _offset = {};
+    _capacity = {};
+    _size = {};
+  }
+
+  [[nodiscard]] bool empty() const {
+    return size() == 0;
+  }
+
+  template <typename T> [[nodiscard]] size_t count_of() const {
+    if constexpr(is_member<T>) {
+      return _size[index<T>];
+    } else {
+      return 0;
+    }
+  }
+
+  [[nodiscard]] size_t size() const {
+    std::size_t sz = 0;
+    for(auto n : _size) {
+      sz += n;
+    }
+    return sz;
+  }
+
+  template <typename T> requires is_member<T> [[nodiscard]] std::size_t capacity() const {
+    return _capacity[index<T>];
+  }
+
+  /**
+   * \brief Reserves space for at least n elements of every type of Us... by a single reallocation
+   * \param n number of elements
+   */
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<Us> && ...))
+  void reserve(std::size_t n) {
+    counts capacity{};
+    ((capacity[index<Us>] = n), ...);
+    reserve_counts(capacity);
+  }
+
+  /// \brief Reallocates the buffer to fit the elements exactly
+  void shrink_to_fit() {
+    if(_size != _capacity) {
+      reallocate(_size);
+    }
+  }
+
+  /// \brief Returns the fraction of the type T as a view over its segment of the buffer
+  template <typename T> requires is_member<T> auto fraction() -> std::span<T> {
+    return {segment<T>(), _size[index<T>]};
+  }
+
+  template <typename T> requires is_member<T> auto fraction() const -> std::span<T const> {
+    return {segment<T>(), _size[index<T>]};
+  }
+
+  /**
+   * \brief Checks presence of the elements of the type T
+   * \return false if T isn't in the schema or its fraction is empty, true otherwise
+   */
+  template <typename T> [[nodiscard]] constexpr bool contains() const {
+    return count_of<T>() > 0;
+  }
+
+  template <std::equality_comparable T, projection_clause... Clauses> requires(sizeof...(Clauses) > 0 && is_member<T>)
+  [[nodiscard]] constexpr bool contains(Clauses &&... clauses) const {
+    auto cmp = [f = fraction<T>()]<typename C>(C && c) -> bool {
+      return std::find_if(f.begin(), f.end(), [&c](T const & value) {
+        return clause_matches(c, value);
+      }) != f.end();
+    };
+    return (... || cmp(std::forward<Clauses>(clauses)));
+  }
+
+  template <typename T, projection_clause Clause> requires is_member<T>
+  auto find(Clause && clause) const -> std::pair<bool, T const *> {
+    auto f = fraction<T>();
+    auto found = std::find_if(f.begin(), f.end(), [&clause](T const & that) {
+      return clause_matches(clause, that);
+    });
+    return std::make_pair(found != f.end(), f.data() + (found - f.begin()));
+  }
+
+  /**
+   * \brief Generates elements accessor for U, Us... types by predicate F
+   * \tparam U type to proceed
+   * \tparam Us types to proceed
+   * \return function which applies predicate F on elements of specified types
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename U, typename... Us> requires (is_member<U> && (is_member<Us> && ...))
+  [[nodiscard]] auto visit() const {
+    return [this]<typename F>(F && f) -> VisitorReturn {
+      return (visit_single<F, U>(std::forward<F>(f)) == VisitorReturn::Break) ||
+      (... || (visit_single<F, Us>(std::forward<F>(f)) == VisitorReturn::Break)) ?
+      VisitorReturn::Break : VisitorReturn::Continue;
+    };
+  }
+
+  /**
+   * \brief Generates elements accessor for U, Us... types by the first applicable predicate of Fs...
+   * \tparam U type to proceed
+   * \tparam Us types to proceed
+   * \return function which applies matched predicate on elements of specified types
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename U, typename... Us>
+  [[nodiscard]] auto match() const {
+    return [this]<typename F, typename... Fs>(F && f, Fs &&... fs) -> bool {
+      return match_single<U>(f, fs...) && (... && match_single<Us>(f, fs...));
+    };
+  }
+
+  template <typename... Us> auto to_tuple() const -> std::tuple<safe_ref<Us>...> {
+    if(!(contains<safe_ref<Us>>() && ...)) {
+      throw std::out_of_range("try to access unbounded value");
+    }
+    return [this]<std::size_t... Is>(std::index_sequence<Is...>) -> std::tuple<safe_ref<Us>...> {
+      return {at<safe_ref<Us>>(details::occurrence_of<Is, safe_ref<Us>...>()) ...};
+    }(std::index_sequence_for<Us...>{});
+  }
+
+  template <typename... Us> auto try_to_tuple() const -> expected<std::tuple<safe_ref<Us>...>, access::error_code> {
+    if(!(contains<safe_ref<Us>>() && ...)) {
+      return make_unexpected(access::error_code::ValueNotFound);
+    }
+    return [this]<std::size_t... Is>(std::index_sequence<Is...>) -> std::tuple<safe_ref<Us>...> {
+      return {at<safe_ref<Us>>(details::occurrence_of<Is, safe_ref<Us>...>()) ...};
+    }(std::index_sequence_for<Us...>{});
+  }
+
+private:
+  // erases by the index, the public erase(index) loses the overload resolution to erase(value) for integral T
+  template <typename T> void erase_at(std::size_t index) {
+    if(index >= count_of<T>()) {
+      throw std::out_of_range(access_error_code(access::error_code::ValueNotFound).message());
+    }
+    auto f = fraction<T>();
+    std::memmove(f.data() + index, f.data() + index + 1, (f.size() - index - 1) * sizeof(T));
+    --_size[packed_hetero_container::index<T>];
+  }
+
+  template <typename T> T * segment() {
+    return _data != nullptr ? reinterpret_cast<T *>(_data + _offset[index<T>]) : nullptr;
+  }
+
+  template <typename T> T const * segment() const {
+    return _data != nullptr ? reinterpret_cast<T const *>(_data + _offset[index<T>]) : nullptr;
+  }
+
+  // the value is taken by copy since it may live in the buffer which is about to be reallocated
+  template <typename T> T & push_front_single(T t) {
+    ensure_capacity<T>();
+    auto p = segment<T>();
+    std::memmove(p + 1, p, _size[index<T>]++ * sizeof(T));
+    return *std::construct_at(p, t);
+  }
+
+  template <typename T> T & push_back_single(T t) {
+    ensure_capacity<T>();
+    return *std::construct_at(segment<T>() + _size[index<T>]++, t);
+  }
+
+  template <typename F, typename U> auto visit_single(F && visitor) const -> VisitorReturn {
+    static_assert(std::is_invocable_v<F, U>, "predicate should accept provided type");
+    for(auto & c : fraction<U>()) {
+      if(visitor(c) == VisitorReturn::Break) {
+        return VisitorReturn::Break;
+      }
+    }
+    return VisitorReturn::Continue;
+  }
+
+  template <typename U, typename... Fs> constexpr bool match_single(Fs &&... fs) const {
+    if constexpr(is_member<U>) {
+      auto f = stg::util::fn_select_applicable<U>::check(std::forward<Fs>(fs)...);
+      for(auto & c : fraction<U>()) {
+        f(c);
+      }
+      return !fraction<U>().empty();
+    } else {
+      return false;
+    }
+  }
+
+  template <typename... Us> static counts counts_of() {
+    counts n{};
+    ((++n[index<Us>]), ...);
+    return n;
+  }
+
+  template <typename T> void ensure_capacity() {
+    if(auto i = index<T>; _size[i] == _capacity[i]) {
+      auto capacity = _capacity;
+      capacity[i] = std::max<std::size_t>(capacity[i] * 2, 8);
+      reallocate(capacity);
+    }
+  }
+
+  void reserve_counts(counts const & n) {
+    auto capacity = _capacity;
+    bool grow = false;
+    for(std::size_t i = 0; i < types_count; ++i) {
+      if(n[i] > capacity[i]) {
+        capacity[i] = n[i];
+        grow = true;
+      }
+    }
+    if(grow) {
+      reallocate(capacity);
+    }
+  }
+
+  // lays segments of the given capacities out one after another, each aligned to its type
+  void reallocate(counts const & capacity) {
+    counts offset{};
+    std::size_t bytes = 0;
+    for(std::size_t i = 0; i < types_count; ++i) {
+      bytes = (bytes + type_alignments[i] - 1) / type_alignments[i] * type_alignments[i];
+      offset[i] = bytes;
+      bytes += capacity[i] * type_sizes[i];
+    }
+    auto data = bytes > 0 ? allocate(bytes) : nullptr;
+    for(std::size_t i = 0; i < types_count; ++i) {
+      if(_size[i] > 0) {
+        std::memcpy(data + offset[i], _data + _offset[i], _size[i] * type_sizes[i]);
+      }
+    }
+    deallocate();
+    _data = data;
+    _bytes = bytes;
+    _offset = offset;
+    _capacity = capacity;
+  }
+
+  // the prefix of the buffer up to the end of the last used segment
+  [[nodiscard]] std::size_t used_bytes() const {
+    std::size_t used = 0;
+    for(std::size_t i = 0; i < types_count; ++i) {
+      if(_size[i] > 0) {
+        used = _offset[i] + _size[i] * type_sizes[i];
+      }
+    }
+    return used;
+  }
+
+  std::byte * allocate(std::size_t bytes) {
+    return static_cast<std::byte *>(_resource->allocate(bytes, alignment));
+  }
+
+  void deallocate() {
+    if(_data != nullptr) {
+      _resource->deallocate(std::exchange(_data, nullptr), _bytes, alignment);
+    }
+  }
+
+  [[nodiscard]] bool same_resource(packed_hetero_container const & other) const noexcept {
+    return _resource == other._resource || _resource->is_equal(*other._resource);
+  }
+
+  std::pmr::memory_resource * _resource = std::pmr::get_default_resource();
+  std::byte * _data = nullptr;
+  std::size_t _bytes = 0;
+  counts _offset{};
+  counts _capacity{};
+  counts _size{};
+};
+
+template <typename... Ts> using spacked = packed_hetero_container<Ts...>;
+
+} // namespace het
+
+#endif //HETLIB_HET_PACKED_CONTAINER_H
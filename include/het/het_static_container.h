@@ -0,0 +1,401 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#ifndef HETLIB_HET_STATIC_CONTAINER_H
+#define HETLIB_HET_STATIC_CONTAINER_H
+
+#include "details/domains.h"
+#include "details/expected.h"
+#include "details/error.h"
+#include "details/typesafe.h"
+#include "details/type_list.h"
+#include "details/query_expression.h"
+
+#include <deque>
+#include <vector>
+
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace het {
+
+using tl::expected;
+using tl::make_unexpected;
+
+using namespace metaf::util;
+
+/**
+ * \brief Heterogeneous container with the closed set of types Ts...
+ * \tparam InnerC fraction container
+ * \tparam Ts types of the elements, every type is resolved at compile time
+ */
+template <template <typename...> class InnerC, typename... Ts> requires details::is_unique<Ts...>
+class static_hetero_container {
+  template <typename T> static constexpr bool is_member = details::is_one_of<T, Ts...>;
+
+public:
+  template <typename T> using inner_iterator = typename InnerC<T>::iterator;
+  template <typename T> using inner_const_iterator = typename InnerC<T>::const_iterator;
+
+  static_hetero_container() = default;
+  static_hetero_container(static_hetero_container const & other) = default;
+  static_hetero_container(static_hetero_container && other) noexcept = default;
+
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<std::remove_cvref_t<Us>> && ...))
+  explicit static_hetero_container(Us &&... us) {
+    (push_back_single(std::forward<Us>(us)), ...);
+  }
+
+  ~static_hetero_container() = default;
+
+  static_hetero_container & operator=(static_hetero_container const & other) = default;
+  static_hetero_container & operator=(static_hetero_container && other) noexcept = default;
+
+  /**
+   * @brief Inserts new element t before position pos
+   * @tparam T -- type bucket
+   * @param pos -- position to insert
+   * @param t -- element to insert
+   * @return iterator of the element
+   */
+  template <typename T> requires is_member<T> inner_iterator<T> insert(inner_iterator<T> pos, T const & t) {
+    return fraction<T>().insert(pos, t);
+  }
+
+  template <typename T> requires is_member<T> inner_iterator<T> insert(inner_iterator<T> pos, T && t) {
+    return fraction<T>().insert(pos, std::move(t));
+  }
+
+  template <typename T, typename... Args> requires is_member<T> T & emplace(inner_iterator<T> pos, Args &&... args) {
+    return *fraction<T>().emplace(pos, std::forward<Args>(args)...);
+  }
+
+  template <typename T, typename... Args> requires is_member<T> T & emplace_front(Args &&... args) {
+    auto & c = fraction<T>();
+    return *c.emplace(c.begin(), std::forward<Args>(args)...);
+  }
+
+  template <typename T, typename... Args> requires is_member<T> T & emplace_back(Args &&... args) {
+    return fraction<T>().emplace_back(std::forward<Args>(args)...);
+  }
+
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<std::remove_cvref_t<Us>> && ...))
+  void push_front(Us &&... us) {
+    (push_front_single(std::forward<Us>(us)), ...);
+  }
+
+  template <typename... Us> requires (sizeof...(Us) > 0 && (is_member<std::remove_cvref_t<Us>> && ...))
+  void push_back(Us &&... us) {
+    (push_back_single(std::forward<Us>(us)), ...);
+  }
+
+  template <typename T> requires is_member<T> void pop_front() {
+    auto & c = fraction<T>();
+    c.erase(c.begin());
+  }
+
+  template <typename T> requires is_member<T> void pop_back() {
+    auto & c = fraction<T>();
+    c.erase(std::prev(c.end()));
+  }
+
+  template <std::equality_comparable T> requires is_member<T> void erase(std::size_t index) {
+    auto & c = fraction<T>();
+    c.erase(std::begin(c) + index);
+  }
+
+  template <std::equality_comparable T> requires is_member<T> bool erase(T const & e) {
+    auto & c = fraction<T>();
+    if(auto it = std::find(c.begin(), c.end(), e); it != c.end()) {
+      c.erase(it);
+      return true;
+    }
+    return false;
+  }
+
+  template <typename T> requires is_member<T> T & at(std::size_t index) {
+    return fraction<T>().at(index);
+  }
+
+  template <typename T> requires is_member<T> T const & at(std::size_t index) const {
+    return fraction<T>().at(index);
+  }
+
+  void clear() {
+    std::apply([](auto &... fs) { (fs.clear(), ...); }, _fractions);
+  }
+
+  [[nodiscard]] bool empty() const {
+    return std::apply([](auto const &... fs) { return (fs.empty() && ...); }, _fractions);
+  }
+
+  template <typename T> [[nodiscard]] size_t count_of() const {
+    if constexpr(is_member<T>) {
+      return fraction<T>().size();
+    } else {
+      return 0;
+    }
+  }
+
+  [[nodiscard]] size_t size() const {
+    return std::apply([](auto const &... fs) { return (std::size_t{0} + ... + fs.size()); }, _fractions);
+  }
+
+  template <typename T> requires is_member<T> auto fraction() -> InnerC<T> & {
+    return std::get<details::index_of<T, Ts...>()>(_fractions);
+  }
+
+  template <typename T> requires is_member<T> auto fraction() const -> InnerC<T> const & {
+    return std::get<details::index_of<T, Ts...>()>(_fractions);
+  }
+
+  /**
+   * \brief Checks presence of the elements of the type T
+   * \return false if T isn't in the schema or its fraction is empty, true otherwise
+   */
+  template <typename T> [[nodiscard]] constexpr bool contains() const {
+    if constexpr(is_member<T>) {
+      return !fraction<T>().empty();
+    } else {
+      return false;
+    }
+  }
+
+  template <std::equality_comparable T, projection_clause... Clauses> requires(sizeof...(Clauses) > 0 && is_member<T>)
+  [[nodiscard]] constexpr bool contains(Clauses &&... clauses) const {
+    auto cmp = [&f = fraction<T>()]<typename C>(C && c) -> bool {
+      return std::find_if(std::cbegin(f), std::cend(f), [&c](T const & value) {
+        return clause_matches(c, value);
+      }) != std::cend(f);
+    };
+    return (... || cmp(std::forward<Clauses>(clauses)));
+  }
+
+  template <typename T, projection_clause Clause> requires is_member<T>
+  auto find(Clause && clause) const -> std::pair<bool, inner_const_iterator<T>> {
+    auto & f = fraction<T>();
+    auto found = std::find_if(std::begin(f), std::end(f), [&clause](T const & that) {
+      return clause_matches(clause, that);
+    });
+    return std::make_pair(found != std::end(f), found);
+  }
+
+  /**
+   * \brief Generates elements accessor for U, Us... types by predicate F
+   * \tparam U type to proceed
+   * \tparam Us types to proceed
+   * \return function which applies predicate F on elements of specified types
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename U, typename... Us> requires (is_member<U> && (is_member<Us> && ...))
+  [[nodiscard]] auto visit() const {
+    return [this]<typename F>(F && f) -> VisitorReturn {
+      return (visit_single<F, U>(std::forward<F>(f)) == VisitorReturn::Break) ||
+      (... || (visit_single<F, Us>(std::forward<F>(f)) == VisitorReturn::Break)) ?
+      VisitorReturn::Break : VisitorReturn::Continue;
+    };
+  }
+
+  /**
+   * \brief Generates elements accessor for U, Us... types by the first applicable predicate of Fs...
+   * \tparam U type to proceed
+   * \tparam Us types to proceed
+   * \return function which applies matched predicate on elements of specified types
+   * \attention it captures `this` pointer, watch for the object lifetime
+   */
+  template <typename U, typename... Us>
+  [[nodiscard]] auto match() const {
+    return [this]<typename F, typename... Fs>(F && f, Fs &&... fs) -> bool {
+      return match_single<U>(f, fs...) && (... && match_single<Us>(f, fs...));
+    };
+  }
+
+  template <typename... Us> auto to_tuple() const -> std::tuple<safe_ref<Us>...> {
+    if(!(contains<safe_ref<Us>>() && ...)) {
+      throw std::out_of_range("try to access unbounded value");
+    }
+    return [this]<std::size_t... Is>(std::index_sequence<Is...>) -> std::tuple<safe_ref<Us>...> {
+      return {fraction<safe_ref<Us>>().at(details::occurrence_of<Is, safe_ref<Us>...>()) ...};
+    }(std::index_sequence_for<Us...>{});
+  }
+
+  template <typename... Us> auto try_to_tuple() const -> expected<std::tuple<safe_ref<Us>...>, access::error_code> {
+    if(!(contains<safe_ref<Us>>() && ...)) {
+      return make_unexpected(access::error_code::ValueNotFound);
+    }
+    return [this]<std::size_t... Is>(std::index_sequence<Is...>) -> std::tuple<safe_ref<Us>...> {
+      return {fraction<safe_ref<Us>>().at(details::occurrence_of<Is, safe_ref<Us>...>()) ...};
+    }(std::index_sequence_for<Us...>{});
+  }
+
+private:
+  template <typename U> auto push_front_single(U && u) -> inner_iterator<std::remove_cvref_t<U>> {
+    auto & c = fraction<std::remove_cvref_t<U>>();
+    return c.insert(std::begin(c), std::forward<U>(u));
+  }
+
+  template <typename U> auto push_back_single(U && u) -> inner_iterator<std::remove_cvref_t<U>> {
+    auto & c = fraction<std::remove_cvref_t<U>>();
+    return c.insert(std::end(c), std::forward<U>(u));
+  }
+
+  template <typename F, typename U> auto visit_single(F && visitor) const -> VisitorReturn {
+    static_assert(std::is_invocable_v<F, U>, "predicate should accept provided type");
+    for(auto & c : fraction<U>()) {
+      if(visitor(c) == VisitorReturn::Break) {
+        return VisitorReturn::Break;
+      }
+    }
+    return VisitorReturn::Continue;
+  }
+
+  template <typename U, typename... Fs> constexpr bool match_single(Fs &&... fs) const {
+    if constexpr(is_member<U>) {
+      auto f = stg::util::fn_select_applicable<U>::check(std::forward<Fs>(fs)...);
+      auto & fr = fraction<U>();
+      for(auto & c : fr) {
+        f(c);
+      }
+      return !fr.empty();
+    } else {
+      return false;
+    }
+  }
+
+  std::tuple<InnerC<Ts>...> _fractions;
+};
+
+/**
+ * \brief Finds first occurrence of the element of the type T matched against predicate F
+ * \tparam T type of the element to search
+ * \tparam F type of the match predicate
+ * \param hc container to search
+ * \param f match predicate
+ * \return pair of presence flag and iterator (true and
+ *          valid iterator points to the element and false and end iterator otherwise)
+ */
+template <typename T, template <typename...> class InnerC, typename... Ts, std::invocable<T> F>
+constexpr auto find_first(static_hetero_container<InnerC, Ts...> const & hc, F && f) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  auto & fr = hc.template fraction<T>();
+  auto found = std::find_if(fr.begin(), fr.end(), std::forward<F>(f));
+  return std::pair{found != fr.end(), found};
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, std::invocable<T> F>
+constexpr auto find_next(static_hetero_container<InnerC, Ts...> const & hc,
+                         typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T> pos, F && f) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  auto & fr = hc.template fraction<T>();
+  auto found = std::find_if(std::next(pos), fr.end(), std::forward<F>(f));
+  return std::pair{found != fr.end(), found};
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, std::invocable<T> F>
+constexpr auto find_prev(static_hetero_container<InnerC, Ts...> const & hc,
+                         typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T> pos, F && f) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  auto & fr = hc.template fraction<T>();
+  while(pos != fr.begin()) {
+    if(std::forward<F>(f)(*--pos)) {
+      return std::pair{true, pos};
+    }
+  }
+  return std::pair{false, fr.end()};
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, std::invocable<T> F>
+constexpr auto find_last(static_hetero_container<InnerC, Ts...> const & hc, F && f) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return find_prev<T>(hc, hc.template fraction<T>().end(), std::forward<F>(f));
+}
+
+/**
+ * \brief Finds all elements of the type T matched to predicate F
+ * \tparam T type of the element to search
+ * \tparam F type of the match predicate
+ * \param hc container to search
+ * \param output container to place result set
+ * \param f match predicate
+ * \return false if result set is empty, true otherwise
+ */
+template <typename T, template <typename...> class InnerC, typename... Ts, std::output_iterator<T> O, std::invocable<T> F>
+constexpr bool find_all(static_hetero_container<InnerC, Ts...> const & hc, O output, F && f) {
+  std::size_t copied = 0;
+  for(auto && e : hc.template fraction<T>()) {
+    if(std::forward<F>(f)(e)) {
+      output = e;
+      output++;
+      copied++;
+    }
+  }
+  return copied > 0;
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, typename F, projection_clause Clause, projection_clause... Clauses>
+requires std::conjunction_v<std::is_invocable<F, Clause, T>, std::is_invocable<F, Clauses, T>...>
+constexpr auto query_first_if(static_hetero_container<InnerC, Ts...> const & hc, F && f, Clause && clause, Clauses &&... clauses) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return find_first<T>(hc, [&](T const & e) {
+    return std::forward<F>(f)(std::forward<Clause>(clause), e) && (... && std::forward<F>(f)(std::forward<Clauses>(clauses), e));
+  });
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, projection_clause Clause, projection_clause... Clauses>
+constexpr auto query_first(static_hetero_container<InnerC, Ts...> const & hc, Clause && clause, Clauses &&... clauses) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return query_first_if<T>(hc, []<typename C, typename Obj>(C && c, Obj const & obj) {
+    return clause_matches(c, obj);
+  }, std::forward<Clause>(clause), std::forward<Clauses>(clauses)...);
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, typename F, projection_clause Clause, projection_clause... Clauses>
+requires std::conjunction_v<std::is_invocable<F, Clause, T>, std::is_invocable<F, Clauses, T>...>
+constexpr auto query_last_if(static_hetero_container<InnerC, Ts...> const & hc, F && f, Clause && clause, Clauses &&... clauses) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return find_last<T>(hc, [&](T const & e) {
+    return std::forward<F>(f)(std::forward<Clause>(clause), e) && (... && std::forward<F>(f)(std::forward<Clauses>(clauses), e));
+  });
+}
+
+template <typename T, template <typename...> class InnerC, typename... Ts, projection_clause Clause, projection_clause... Clauses>
+constexpr auto query_last(static_hetero_container<InnerC, Ts...> const & hc, Clause && clause, Clauses &&... clauses) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return query_last_if<T>(hc, []<typename C, typename Obj>(C && c, Obj const & obj) {
+    return clause_matches(c, obj);
+  }, std::forward<Clause>(clause), std::forward<Clauses>(clauses)...);
+}
+
+/// \brief Finds the first element of the type T satisfying the query expression, see where() and field()
+template <typename T, template <typename...> class InnerC, typename... Ts, query_expression E>
+constexpr auto query_first(static_hetero_container<InnerC, Ts...> const & hc, E const & expression) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return find_first<T>(hc, expression);
+}
+
+/// \brief Finds the last element of the type T satisfying the query expression, see where() and field()
+template <typename T, template <typename...> class InnerC, typename... Ts, query_expression E>
+constexpr auto query_last(static_hetero_container<InnerC, Ts...> const & hc, E const & expression) ->
+std::pair<bool, typename static_hetero_container<InnerC, Ts...>::template inner_const_iterator<T>> {
+  return find_last<T>(hc, expression);
+}
+
+template <typename... Us, template <typename...> class InnerC, typename... Ts>
+auto to_tuple(static_hetero_container<InnerC, Ts...> const & hc) -> std::tuple<safe_ref<Us>...> {
+  return hc.template to_tuple<Us...>();
+}
+
+template <typename... Us, template <typename...> class InnerC, typename... Ts>
+auto try_to_tuple(static_hetero_container<InnerC, Ts...> const & hc) -> expected<std::tuple<safe_ref<Us>...>, access::error_code> {
+  return hc.template try_to_tuple<Us...>();
+}
+
+template <typename... Ts> using svector = static_hetero_container<std::vector, Ts...>;
+template <typename... Ts> using sdeque = static_hetero_container<std::deque, Ts...>;
+
+} // namespace het
+
+#endif //HETLIB_HET_STATIC_CONTAINER_H
@@ -10,10 +10,14 @@
 #include <tuple>
 #include <functional>
 #include <unordered_map>
+#include <memory>
+#include <memory_resource>
 
 #include "details/expected.h"
 #include "details/error.h"
 #include "details/typesafe.h"
+#include "details/sharded_map.h"
+#include "details/memory_usage.h"
 
 namespace het {
 
@@ -30,13 +34,25 @@ class hetero_value {
 
 public:
   hetero_value() = default;
+  /**
+   * \brief Creates empty object keeping its bookkeeping and allocator-aware values in the memory resource
+   * \param resource memory resource, must outlive the object
+   * \note registry nodes are allocated by the registry allocator
+   */
+  explicit hetero_value(std::pmr::memory_resource * resource) noexcept : _resource(resource) {}
   hetero_value(hetero_value const & value) {
     assign(value);
   }
-  hetero_value(hetero_value && value) noexcept {
+  /// \brief Takes over values along with the memory resource, may throw what re-keying the registry nodes throws
+  hetero_value(hetero_value && value) : _resource(value._resource) {
     assign(std::move(value));
   }
-  template <typename... Ts> explicit hetero_value(Ts &&... ts) {
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_value> && ...)
+  explicit hetero_value(Ts &&... ts) {
+    (add_value(std::forward<Ts>(ts)), ...);
+  }
+  template <typename... Ts> requires (is_element_argument<Ts, hetero_value> && ...)
+  hetero_value(std::allocator_arg_t, std::pmr::memory_resource * resource, Ts &&... ts) : _resource(resource) {
     (add_value(std::forward<Ts>(ts)), ...);
   }
 
@@ -49,23 +65,66 @@ public:
     return *this;
   }
 
-  hetero_value & operator=(hetero_value && value) noexcept {
+  hetero_value & operator=(hetero_value && value) {
     assign(std::move(value));
     return *this;
   }
 
   void assign(hetero_value const & value) {
+    if(&value == this) {
+      return;
+    }
     clear();
-    _clear_functions = value._clear_functions;
-    _copy_functions = value._copy_functions;
+    _ops = value._ops;
     _arity = value.arity();
-    for (auto && copy : _copy_functions) {
-      copy(value, *this);
+    for (auto && ops : _ops) {
+      ops->copy(value, *this);
     }
   }
 
-  void assign(hetero_value && value) noexcept {
-    assign(static_cast<hetero_value const *>(value));
+  /**
+   * \brief Takes over values of the other object without touching them
+   * \param value object to move from, it's left empty
+   * \note costs O(arity), each value node is re-keyed in its registry
+   * \attention memory resources are not propagated, if they differ allocator-aware values are moved one by one
+   * \throw what the allocation of the moved values throws when the resources differ
+   */
+  void assign(hetero_value && value) {
+    if(&value == this) {
+      return;
+    }
+    clear();
+    // the operations are taken first, so that clear() finds the values moved so far if a move throws
+    _ops = value._ops;
+    _arity = value._arity;
+    try {
+      for (auto && ops : value._ops) {
+        ops->move(value, *this);
+      }
+    } catch(...) {
+      clear(); // releases the values moved so far, the other object keeps the rest
+      throw;
+    }
+    if(same_resource(value)) {
+      value._ops.clear();
+      value._arity = 0;
+    } else {
+      value.clear(); // releases what is left of the moved values
+    }
+  }
+
+  void swap(hetero_value & value) {
+    hetero_value tmp(std::move(value));
+    value.assign(std::move(*this));
+    assign(std::move(tmp));
+  }
+
+  friend void swap(hetero_value & lhs, hetero_value & rhs) {
+    lhs.swap(rhs);
+  }
+
+  [[nodiscard]] std::pmr::memory_resource * resource() const noexcept {
+    return _resource;
   }
 
   template <typename... Ts> void assign_values(Ts const &... values) {
@@ -143,9 +202,11 @@ public:
   }
 
   void clear() {
-    for (auto && clear : _clear_functions) {
-      clear(*this);
+    for (auto && ops : _ops) {
+      ops->release(*this);
     }
+    _ops.clear();
+    _arity = 0;
   }
 
   [[nodiscard]] bool empty() const {
@@ -156,6 +217,32 @@ public:
     return _arity;
   }
 
+  /**
+   * \brief Reports memory used by the object, in total and per value type
+   * \return memory report, types are listed in order of registration
+   * \note the object footprint itself is not included, neither are the registry buckets shared
+   *       by all the objects, see registry_stats()
+   */
+  [[nodiscard]] memory_report memory_usage() const {
+    memory_report r;
+    r.types.reserve(_ops.size());
+    for (auto && ops : _ops) {
+      r.types.push_back(ops->usage(*this));
+      r.total += r.types.back().usage;
+    }
+    r.total.bookkeeping_bytes += _ops.capacity() * sizeof(value_ops const *);
+    return r;
+  }
+
+  /**
+   * \brief Reports the process-wide registry of the type T values
+   * \tparam T value type
+   * \return size, bucket count and load factor of the registry
+   */
+  template <typename T> [[nodiscard]] static registry_statistics registry_stats() {
+    return details::statistics_of(hetero_value::values<T>());
+  }
+
   template <typename T, typename... Ts>
   [[nodiscard]] constexpr auto visit() const {
     return [this]<typename F>(F && f) -> VisitorReturn {
@@ -217,7 +304,16 @@ private:
   template <typename T> auto add_value(T && value) -> typename C<hetero_value const *, T>::iterator {
     register_operations<T>();
     auto & vs = hetero_value::values<T>();
-    return vs.insert_or_assign(this, std::forward<T>(value)).first;
+    return vs.insert_or_assign(this, make_value<T>(std::forward<T>(value))).first;
+  }
+
+  // allocator-aware values are rebuilt by the memory resource of the object, the rest are passed through
+  template <typename T, typename U> decltype(auto) make_value(U && u) const {
+    if constexpr(std::uses_allocator_v<std::remove_cv_t<T>, std::pmr::polymorphic_allocator<>>) {
+      return std::make_obj_using_allocator<std::remove_cv_t<T>>(std::pmr::polymorphic_allocator<>(_resource), std::forward<U>(u));
+    } else {
+      return std::forward<U>(u);
+    }
   }
 
   template <typename T> void erase_value() {
@@ -230,28 +326,74 @@ private:
   template<typename T> auto register_operations() -> typename C<hetero_value const *, T>::iterator {
     auto & vs = hetero_value::values<T>();
     auto it = vs.find(this);
-    // don't have it yet, so create functions for copying and destroying
+    // don't have it yet, so register operations for copying, moving and destroying
     if (it == std::end(vs)) {
-      _clear_functions.template emplace_back([](hetero_value & c) { hetero_value::values<T>().erase(&c); });
-      // if someone copies me, they need to call each copy_function and pass themself
-      _copy_functions.template emplace_back([](const hetero_value & from, hetero_value & to) {
-        if(&from != &to) {
-          auto & vs = hetero_value::values<T>();
-          if constexpr(std::is_copy_constructible_v<T>) {
-            vs.insert_or_assign(&to, from.value<T>());
-          } else {
-            vs.insert_or_assign(&to, std::move(const_cast<hetero_value&>(from).value<T>()));
-          }
-        }
-      });
+      _ops.push_back(&ops_of<T>);
       _arity++;
     }
     return it;
   }
 
+  template <typename T> void copy_value(hetero_value const & from) {
+    if(&from != this) {
+      auto & vs = hetero_value::values<T>();
+      if constexpr(std::is_copy_constructible_v<T>) {
+        vs.insert_or_assign(this, make_value<T>(from.value<T>()));
+      } else {
+        vs.insert_or_assign(this, make_value<T>(std::move(const_cast<hetero_value&>(from).value<T>())));
+      }
+    }
+  }
+
+  // re-keys the registry node of the value, allocator-aware value of the foreign memory resource is moved instead
+  template <typename T> void move_value(hetero_value & from) {
+    auto & vs = hetero_value::values<T>();
+    if(std::uses_allocator_v<std::remove_cv_t<T>, std::pmr::polymorphic_allocator<>> && !same_resource(from)) {
+      if(auto it = vs.find(&from); it != std::end(vs)) {
+        vs.insert_or_assign(this, make_value<T>(std::move(it->second)));
+      }
+    } else if constexpr(requires { vs.extract(&from); }) {
+      if(auto node = vs.extract(&from); !node.empty()) {
+        node.key() = this;
+        vs.insert(std::move(node));
+      }
+    } else if(auto it = vs.find(&from); it != std::end(vs)) {
+      vs.insert_or_assign(this, std::move(it->second));
+      vs.erase(&from);
+    }
+  }
+
+  // the value is kept by the registry node keyed by the object address
+  template <typename T> auto value_usage() const -> type_memory_usage {
+    if(!contains<T>()) {
+      return {typeid(T), typeid(void), 0, {}};
+    }
+    return {typeid(T), typeid(void), 1, {sizeof(T), 0, details::node_bytes<C<hetero_value const *, T>> - sizeof(T)}};
+  }
+
+  // type-erased operations over the value of a single type
+  struct value_ops {
+    void (*release)(hetero_value &);
+    void (*copy)(hetero_value const &, hetero_value &);
+    void (*move)(hetero_value &, hetero_value &);
+    type_memory_usage (*usage)(hetero_value const &);
+  };
+
+  template <typename T> static constexpr value_ops ops_of{
+    [](hetero_value & c) { hetero_value::values<T>().erase(&c); },
+    [](hetero_value const & from, hetero_value & to) { to.template copy_value<T>(from); },
+    [](hetero_value & from, hetero_value & to) { to.template move_value<T>(from); },
+    [](hetero_value const & c) -> type_memory_usage { return c.template value_usage<T>(); }
+  };
+
+  [[nodiscard]] bool same_resource(hetero_value const & other) const noexcept {
+    return _resource == other._resource || _resource->is_equal(*other._resource);
+  }
+
+  std::pmr::memory_resource * _resource = std::pmr::get_default_resource();
   std::size_t _arity{0};
-  std::vector<std::function<void(hetero_value &)>> _clear_functions;
-  std::vector<std::function<void(const hetero_value &, hetero_value &)>> _copy_functions;
+  // operations of the registered types, in order of registration
+  std::pmr::vector<value_ops const *> _ops = std::pmr::vector<value_ops const *>(_resource);
 };
 
 template <template <typename, typename, typename...> typename C>
@@ -324,6 +466,7 @@ auto try_to_tuple(hetero_value<C> && hv) -> expected<std::tuple<safe_ref<Ts>...>
 }
 
 using hvalue = hetero_value<std::unordered_map>;
+using concurrent_hvalue = hetero_value<sharded_map>;
 
 } // namespace het
 
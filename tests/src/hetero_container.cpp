@@ -13,6 +13,17 @@
 #include <tuple>
 #include <sstream>
 #include <memory>
+#include <memory_resource>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <ranges>
+#include <variant>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -276,3 +287,1144 @@ TEST_CASE("vector based container het::match test") {
           );
   CHECK(ss.str() == "21default2");
 }
+
+// the registry re-keys the fraction nodes on move, which may throw, the indexed storage takes over its table
+static_assert(std::is_nothrow_move_constructible_v<het::hvector>);
+static_assert(!std::is_nothrow_move_constructible_v<het::hash_key_container<std::vector>>);
+
+TEST_CASE_TEMPLATE("heterogeneous container move and swap test", HC,
+                   het::hvector, het::hash_key_container<std::vector>, het::concurrent_key_container<std::vector>, het::hsmall_vector<>) {
+  HC hc(1, 2, "foo"s);
+  auto const * pi = hc.template fraction<int>().data();
+  HC hc1(std::move(hc));
+  CHECK(hc.empty());
+  CHECK(!hc.template contains<int>());
+  CHECK(hc1.size() == 3);
+  CHECK(hc1.template fraction<int>().data() == pi);
+
+  HC hc2(1.);
+  hc2.swap(hc1);
+  CHECK(hc1.size() == 1);
+  CHECK(hc1.template at<double>(0) == 1.);
+  CHECK(hc2.size() == 3);
+  CHECK(hc2.template fraction<int>().data() == pi);
+
+  hc1 = std::move(hc2);
+  CHECK(hc2.empty());
+  CHECK(!hc1.template contains<double>());
+  CHECK(hc1.template fraction<int>().data() == pi);
+  CHECK(hc1.template at<std::string>(0) == "foo");
+
+  HC hc3(hc1);
+  CHECK(hc3.size() == 3);
+  CHECK(hc3.template fraction<int>().data() != pi);
+}
+
+TEST_CASE("small vector test") {
+  het::small_vector<std::string, 2> v;
+  CHECK(v.is_inline());
+  v.push_back("b"s);
+  v.insert(v.begin(), "a"s);
+  CHECK(v.is_inline());
+  CHECK(v.capacity() == 2);
+  v.emplace_back(v.front()); // the argument refers to the storage being reallocated
+  CHECK(!v.is_inline());
+  CHECK((v == het::small_vector<std::string, 2>{"a"s, "b"s, "a"s}));
+  v.insert(v.begin() + 1, v.back());
+  CHECK((v == het::small_vector<std::string, 2>{"a"s, "a"s, "b"s, "a"s}));
+  v.erase(v.begin(), v.begin() + 2);
+  v.shrink_to_fit();
+  CHECK(v.is_inline());
+  CHECK((v == het::small_vector<std::string, 2>{"b"s, "a"s}));
+
+  auto v1 = v;
+  auto v2 = std::move(v);
+  CHECK(v.empty());
+  CHECK(v1 == v2);
+  v2.resize(5, "c"s);
+  CHECK(v2.size() == 5);
+  CHECK(v2.at(4) == "c");
+  CHECK_THROWS_AS((void)v2.at(5), std::out_of_range);
+  swap(v1, v2);
+  CHECK(v1.size() == 5);
+  CHECK(v2.size() == 2);
+  v1.pop_back();
+  v1.insert(v1.end(), v2.begin(), v2.end());
+  CHECK(v1.size() == 6);
+  CHECK(v1.back() == "a");
+
+  het::small_vector<int, 2> counted(3);
+  CHECK((counted == het::small_vector<int, 2>{0, 0, 0}));
+  static_assert(!std::is_convertible_v<std::size_t, het::small_vector<int, 2>>);
+
+  struct no_default {
+    explicit no_default(int v) : value(v) {}
+    int value;
+  };
+  het::small_vector<no_default, 2> filled(3, no_default(7));
+  CHECK(filled.size() == 3);
+  CHECK(filled.back().value == 7);
+
+  // the elements built before a throwing default constructor are kept by resize and released by the constructor
+  static int alive = 0, budget = 0;
+  struct limited {
+    limited() {
+      if(budget-- == 0) {
+        throw std::length_error("limited");
+      }
+      ++alive;
+    }
+    limited(limited &&) noexcept { ++alive; }
+    ~limited() { --alive; }
+  };
+  budget = 4;
+  CHECK_THROWS_AS((het::small_vector<limited, 2>(6)), std::length_error);
+  CHECK(alive == 0);
+  {
+    het::small_vector<limited, 2> grown;
+    budget = 3;
+    CHECK_THROWS_AS(grown.resize(5), std::length_error);
+    CHECK(grown.size() == 3);
+    CHECK(alive == 3);
+  }
+  CHECK(alive == 0);
+}
+
+TEST_CASE_TEMPLATE("insertion order index test", HC,
+                   het::hvector, het::hash_key_container<std::vector>, het::hsmall_vector<2>) {
+  HC hc;
+  auto ordered = [](HC const & hc) {
+    std::stringstream ss;
+    hc.template ordered_visit<int, float, char, std::string>()([&ss](auto const & v) {
+      ss << v << ' ';
+      return het::VisitorReturn::Continue;
+    });
+    return ss.str();
+  };
+  CHECK_THROWS_AS(hc.template ordered_visit<int>(), std::logic_error);
+  hc.push_back(1, 1.5f);
+  hc.keep_insertion_order();
+  CHECK(hc.keeps_insertion_order());
+  hc.push_back('c', "s"s, 2);
+  hc.push_front(0);
+  CHECK(ordered(hc) == "1 1.5 c s 2 0 ");
+
+  hc.template erase<int>(1);
+  hc.insert(hc.template fraction<int>().begin() + 1, 5);
+  CHECK(ordered(hc) == "1.5 c s 2 0 5 ");
+  hc.template pop_back<int>();
+  hc.template pop_front<float>();
+  hc.template emplace_back<std::string>("t");
+  CHECK(ordered(hc) == "c s 0 5 t ");
+
+  std::stringstream ss;
+  hc.template ordered_visit<int>()([&ss](int v) {
+    ss << v;
+    return v == 0 ? het::VisitorReturn::Break : het::VisitorReturn::Continue;
+  });
+  CHECK(ss.str() == "0");
+
+  HC hc1(hc);
+  HC hc2(std::move(hc));
+  CHECK(ordered(hc1) == "c s 0 5 t ");
+  CHECK(ordered(hc2) == "c s 0 5 t ");
+  hc2.clear();
+  hc2.push_back(3, 'd');
+  CHECK(ordered(hc2) == "3 d ");
+}
+
+TEST_CASE_TEMPLATE("memory resource based container test", HC,
+                   het::pmr_hvector, het::hash_key_container<std::pmr::vector>) {
+  std::array<std::byte, 16 * 1024> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  auto in_arena = [&buffer](void const * p) {
+    return std::less_equal<>{}(buffer.data(), p) && std::less<>{}(p, buffer.data() + buffer.size());
+  };
+  HC hc(&arena);
+  hc.push_back(1, 2, 3.);
+  hc.template emplace_back<std::pmr::string>("string which does not fit into the small string buffer");
+  CHECK(hc.resource() == &arena);
+  CHECK(in_arena(hc.template fraction<int>().data()));
+  CHECK(in_arena(hc.template fraction<std::pmr::string>().front().data()));
+
+  HC hc1(std::move(hc));
+  CHECK(hc1.resource() == &arena);
+  CHECK(in_arena(hc1.template fraction<int>().data()));
+
+  HC hc2;
+  hc2 = std::move(hc1);
+  CHECK(hc1.empty());
+  CHECK(hc2.size() == 4);
+  CHECK(!in_arena(hc2.template fraction<int>().data()));
+  CHECK(hc2.template fraction<std::pmr::string>().front().get_allocator().resource() == std::pmr::get_default_resource());
+
+  HC hc3(hc2, &arena);
+  CHECK(hc3.template at<double>(0) == 3.);
+  CHECK(in_arena(hc3.template fraction<std::pmr::string>().front().data()));
+}
+
+TEST_CASE("move assignment across memory resources test") {
+  // the move to another resource allocates, its failure is thrown rather than terminating
+  struct failing_resource : std::pmr::memory_resource {
+    bool fail = false;
+    void * do_allocate(std::size_t bytes, std::size_t align) override {
+      if(fail) {
+        throw std::bad_alloc();
+      }
+      return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void * p, std::size_t bytes, std::size_t align) override {
+      std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    [[nodiscard]] bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override {
+      return this == &other;
+    }
+  } failing;
+  het::hvector to(&failing);
+  het::hvector from(1, 2.);
+  failing.fail = true;
+  CHECK_THROWS_AS(to = std::move(from), std::bad_alloc);
+  CHECK(to.empty());
+  CHECK(from.size() == 2);
+  failing.fail = false;
+  to = std::move(from);
+  CHECK(to.size() == 2);
+  CHECK(from.empty());
+}
+
+TEST_CASE_TEMPLATE("container memory usage test", HC, het::hvector, het::hash_key_container<std::vector>) {
+  HC hc;
+  CHECK(hc.memory_usage().types.empty());
+  hc.push_back(1, 2, 3, 4.);
+  hc.template fraction<int>().reserve(8);
+  auto report = hc.memory_usage();
+  REQUIRE(report.types.size() == 2);
+  CHECK(report.types[0].type == typeid(int));
+  CHECK(report.types[0].count == 3);
+  CHECK(report.types[0].usage.element_bytes == 3 * sizeof(int));
+  CHECK(report.types[0].usage.slack_bytes == 5 * sizeof(int));
+  CHECK(report.types[0].usage.bookkeeping_bytes >= sizeof(std::vector<int>));
+  CHECK(report.types[1].type == typeid(double));
+  CHECK(report.total.element_bytes == 3 * sizeof(int) + sizeof(double));
+  CHECK(report.total.bookkeeping_bytes > report.types[0].usage.bookkeeping_bytes + report.types[1].usage.bookkeeping_bytes);
+  CHECK(report.total.bytes() == report.total.element_bytes + report.total.slack_bytes + report.total.bookkeeping_bytes);
+  hc.clear();
+  CHECK(hc.memory_usage().total.element_bytes == 0);
+}
+
+TEST_CASE("small vector and registry memory usage test") {
+  het::hsmall_vector<2> hsv(1, 2);
+  CHECK(hsv.memory_usage().types[0].usage.slack_bytes == 0);
+  hsv.push_back(3);
+  CHECK(hsv.memory_usage().types[0].usage.slack_bytes == 3 * sizeof(int)); // one heap slot and the inline buffer
+
+  auto stats = het::hash_key_container<std::vector>::registry_stats<long>();
+  het::hash_key_container<std::vector> hc(1l);
+  auto stats1 = het::hash_key_container<std::vector>::registry_stats<long>();
+  CHECK(stats1.size == stats.size + 1);
+  CHECK(stats1.bucket_count >= stats1.size);
+  CHECK(stats1.load_factor > 0.f);
+  CHECK(het::concurrent_key_container<std::vector>::registry_stats<long>().size == 0);
+}
+
+TEST_CASE_TEMPLATE("bulk insertion and reservation test", HC, het::hvector, het::hash_key_container<std::vector>) {
+  HC hc;
+  hc.keep_insertion_order();
+  hc.push_back(0);
+  hc.template reserve<int, double, std::string>(16, 8, 4);
+  CHECK(hc.template capacity<int>() >= 16);
+  CHECK(hc.template capacity<double>() >= 8);
+  CHECK(hc.template contains<std::string>());
+  CHECK(hc.template count_of<std::string>() == 0);
+  CHECK(hc.template capacity<char>() == 0);
+
+  std::vector<int> ints{1, 2, 3};
+  hc.template append_range<int>(ints);
+  hc.template append_range<double>(std::views::iota(0, 3) | std::views::transform([](int i) { return i * .5; }));
+  std::vector<std::string> strings{"string which does not fit into the small string buffer"s, "b"s};
+  hc.template append_range<std::string>(std::move(strings));
+  CHECK(strings[0].empty());
+  CHECK(hc.size() == 9);
+  CHECK((hc.template fraction<int>() == std::vector<int>{0, 1, 2, 3}));
+  CHECK(hc.template at<double>(2) == 1.);
+
+  std::ostringstream os;
+  hc.template ordered_visit<int, double, std::string>()([&os](auto const & e) {
+    os << e << ' ';
+    return het::VisitorReturn::Continue;
+  });
+  CHECK(os.str() == "0 1 2 3 0 0.5 1 string which does not fit into the small string buffer b ");
+
+  hc.shrink_to_fit();
+  CHECK(hc.template capacity<int>() == 4);
+  CHECK(hc.memory_usage().total.slack_bytes == 0);
+}
+
+TEST_CASE("deque bulk insertion and reservation test") {
+  het::hdeque hd;
+  hd.reserve<int>(8);
+  hd.append_range<int>(std::array{1, 2});
+  CHECK(hd.capacity<int>() == 2);
+}
+
+TEST_CASE_TEMPLATE("erase_if and erase_if_all test", HC,
+                   het::hvector, het::hash_key_container<std::vector>, het::hsmall_vector<>) {
+  HC hc;
+  hc.keep_insertion_order();
+  hc.push_back(1, 2., 3, 4., 5, 'c', 6, "s"s);
+  CHECK(hc.template erase_if<int>([](int i) { return i % 2 == 1; }) == 3);
+  CHECK(hc.template count_of<int>() == 1);
+  CHECK(hc.template at<int>(0) == 6);
+  CHECK(hc.template erase_if<float>([](float) { return true; }) == 0);
+
+  auto erased = hc.template erase_if_all<int, double, char>([](auto const & e) { return e > 3; });
+  CHECK(erased == 3);
+  CHECK(!hc.template contains<int>());
+  CHECK(!hc.template contains<char>());
+  CHECK(hc.template contains<double>());
+  CHECK(hc.size() == 2);
+
+  std::ostringstream os;
+  hc.template ordered_visit<int, double, std::string>()([&os](auto const & e) {
+    os << e << ' ';
+    return het::VisitorReturn::Continue;
+  });
+  CHECK(os.str() == "2 s ");
+
+  hc.template erase<std::string>(0);
+  CHECK(!hc.template contains<std::string>());
+  CHECK(hc.memory_usage().types.size() == 1);
+  hc.push_back(7);
+  CHECK(hc.size() == 2);
+
+  hc.template pop_back<int>();
+  CHECK(!hc.template contains<int>());
+  hc.template pop_front<double>();
+  CHECK(!hc.template contains<double>());
+  CHECK(hc.empty());
+  CHECK(hc.memory_usage().types.empty());
+}
+
+TEST_CASE_TEMPLATE("cached size and type presence test", HC,
+                   het::hvector, het::hdeque, het::hash_key_container<std::vector>) {
+  HC hc;
+  CHECK(hc.empty());
+  CHECK(!hc.template contains<int>());
+  hc.push_back(1, 2, 3.);
+  hc.template emplace_front<int>(0);
+  hc.template insert<double>(hc.template fraction<double>().begin(), 2.);
+  CHECK(hc.size() == 5);
+  CHECK(hc.template contains<int>());
+  CHECK(!hc.template contains<char>());
+  hc.template pop_back<int>();
+  hc.template erase<double>(0);
+  CHECK(hc.size() == 3);
+
+  HC hc1(hc);
+  HC hc2(std::move(hc));
+  CHECK(hc.empty());
+  CHECK(!hc.template contains<int>());
+  CHECK(hc1.size() == 3);
+  CHECK(hc2.size() == 3);
+  CHECK(hc2.template contains<double>());
+  hc1.swap(hc);
+  CHECK(hc1.empty());
+  CHECK(hc.size() == 3);
+
+  hc2.template erase<double>(0);
+  CHECK(!hc2.template contains<double>());
+  hc2.clear();
+  CHECK(hc2.empty());
+  CHECK(!hc2.template contains<int>());
+}
+
+TEST_CASE_TEMPLATE("fraction handle test", HC, het::hvector, het::hash_key_container<std::vector>) {
+  HC hc;
+  CHECK_THROWS_AS((void)hc.template handle<int>(), std::out_of_range);
+  hc.push_back(1, 2.);
+  auto hi = hc.template handle<int>();
+  hc.push_back(2, 3); // growing the fraction keeps the handle valid
+  CHECK(hi.size() == 3);
+  CHECK(hi[1] == 2);
+  hi[2] = 4;
+  CHECK(hc.template at<int>(2) == 4);
+  CHECK(std::accumulate(hi.begin(), hi.end(), 0) == 7);
+  CHECK_THROWS_AS((void)hi.at(3), std::out_of_range);
+
+  auto const & chc = hc;
+  auto chd = chc.template handle<double>();
+  static_assert(std::is_same_v<decltype(chd[0]), double const &>);
+  CHECK(chd.at(0) == 2.);
+  CHECK(&chd.fraction() == &chc.template fraction<double>());
+}
+
+TEST_CASE("slot map test") {
+  het::slot_map<std::string> sm;
+  auto a = sm.insert("a"s);
+  auto b = sm.insert("b"s);
+  auto c = sm.insert("c"s);
+  CHECK(sm.size() == 3);
+  CHECK(sm.erase(a));
+  CHECK(!sm.erase(a));
+  CHECK(!sm.contains(a));
+  CHECK(sm[0] == "c"); // the last element is moved into the hole
+  CHECK(sm.at(b) == "b");
+  CHECK(sm.at(c) == "c");
+  auto d = sm.insert("d"s); // reuses the slot of a with the next generation
+  CHECK(d.index == a.index);
+  CHECK(sm.find(a) == sm.end());
+  CHECK(*sm.find(d) == "d");
+  CHECK_THROWS_AS((void)sm.at(a), std::out_of_range);
+  CHECK(sm.key_of(sm.at(b)) == b);
+  CHECK(sm.erase_if([](auto const & s) { return s != "b"; }) == 2);
+  CHECK(sm.size() == 1);
+  CHECK(sm.at(b) == "b");
+  sm.clear();
+  CHECK(!sm.contains(b));
+
+  // the slot table is shrunk to the slots ever taken, they are kept along with their generations
+  het::slot_map<int> shrunk;
+  shrunk.reserve(64);
+  auto g = shrunk.insert(1);
+  shrunk.insert(2);
+  shrunk.erase(g);
+  shrunk.shrink_to_fit();
+  CHECK(shrunk.index_bytes() <= sizeof(std::uint32_t) + 2 * 2 * sizeof(std::uint32_t));
+  CHECK(!shrunk.contains(g));
+  CHECK(shrunk.insert(3).index == g.index);
+
+  // the moved-from map has no free slots left to take
+  het::slot_map<int> from;
+  auto e = from.insert(1);
+  from.insert(2);
+  CHECK(from.erase(e));
+  het::slot_map<int> to(std::move(from));
+  CHECK(to.size() == 1);
+  auto f = from.insert(3);
+  CHECK(from.size() == 1);
+  CHECK(from.at(f) == 3);
+  CHECK(to.erase(to.key_of(to[0])));
+  to.insert(4);
+  from = std::move(to);
+  CHECK(from.size() == 1);
+  CHECK(from[0] == 4);
+  to.insert(5);
+  CHECK(to.size() == 1);
+  CHECK(to[0] == 5);
+
+  het::hslot_map hc(1, 2., 3);
+  hc.push_back(4, 5.);
+  CHECK_THROWS_AS(hc.keep_insertion_order(), std::logic_error);
+  auto & ints = hc.fraction<int>();
+  auto k = ints.key_of(ints[0]);
+  auto l = ints.key_of(ints[2]);
+  CHECK(hc.erase<int>(k));
+  CHECK(!hc.erase<int>(k));
+  CHECK(hc.size() == 4);
+  CHECK(ints.at(l) == 4);
+  int sum = 0;
+  hc.visit<int>()([&sum](int i) { sum += i; return het::VisitorReturn::Continue; });
+  CHECK(sum == 7);
+  CHECK(hc.erase_if<int>([](int) { return true; }) == 2);
+  CHECK(!hc.contains<int>());
+  CHECK(hc.size() == 2);
+  CHECK(hc.memory_usage().total.bookkeeping_bytes > 0);
+}
+
+struct indexed_record {
+  int id;
+  std::string name;
+
+  [[nodiscard]] std::string const & label() const { return name; }
+  bool operator==(indexed_record const &) const = default;
+};
+
+TEST_CASE_TEMPLATE("hash index test", HC, het::hvector, het::hdeque, het::hash_key_container<std::vector>) {
+  using record = indexed_record;
+  HC hc;
+  hc.push_back(record{1, "a"}, record{2, "b"});
+  hc.template create_index<record>(&record::id);
+  CHECK(hc.template has_index<record>(&record::id));
+  CHECK(!hc.template has_index<record>(&record::name));
+  hc.push_back(record{3, "c"}, record{2, "d"});
+  CHECK(hc.template find<record>(std::pair{&record::id, 2}).second->name == "b");
+  CHECK(het::query_last<record>(hc, std::pair{&record::id, 2}).second->name == "d");
+  CHECK(het::query_first<record>(hc, std::pair{&record::id, 2}, std::pair{&record::name, "d"s}).second->name == "d");
+  CHECK(!het::query_first<record>(hc, std::pair{&record::id, 4}).first);
+  CHECK(hc.template contains<record>(std::pair{&record::id, 3}));
+
+  hc.insert(hc.template fraction<record>().begin(), record{4, "e"}); // shifts the offsets
+  hc.template erase<record>(1);
+  CHECK(!hc.template contains<record>(std::pair{&record::id, 1}));
+  CHECK(hc.template find<record>(std::pair{&record::id, 3}).second->name == "c");
+  CHECK(het::query_first<record>(hc, std::pair{&record::id, 4}).second == hc.template fraction<record>().begin());
+  hc.template erase_if<record>([](record const & r) { return r.name == "b"; });
+  CHECK(het::query_first<record>(hc, std::pair{&record::id, 2}).second->name == "d");
+  hc.template append_range<record>(std::vector{record{5, "f"}, record{6, "g"}});
+  CHECK(hc.template find<record>(std::pair{&record::id, 5}).second->name == "f");
+
+  hc.template create_index<record>(&record::label);
+  CHECK(hc.template find<record>(std::pair{&record::label, "g"sv}).second->id == 6);
+
+  HC hc1(hc);
+  CHECK(hc1.template has_index<record>(&record::label));
+  CHECK(hc1.template find<record>(std::pair{&record::id, 3}).second->name == "c");
+
+  // in place changes of the indexed projection go through modify() or are followed by reindex()
+  auto pos = hc.template find<record>(std::pair{&record::id, 3}).second;
+  hc.template modify<record>(pos, [](record & r) { r.id = 30; });
+  CHECK(!hc.template contains<record>(std::pair{&record::id, 3}));
+  CHECK(hc.template find<record>(std::pair{&record::id, 30}).second->name == "c");
+  CHECK_THROWS_AS(hc.template modify<record>(pos, [](record & r) { r.id = 31; throw std::runtime_error("modify"); }), std::runtime_error);
+  CHECK(hc.template find<record>(std::pair{&record::id, 31}).second->name == "c");
+  hc.template fraction<record>().front().id = 40;
+  CHECK(!hc.template contains<record>(std::pair{&record::id, 40}));
+  hc.template reindex<record>();
+  CHECK(hc.template contains<record>(std::pair{&record::id, 40}));
+
+  hc.clear();
+  CHECK(hc.template has_index<record>(&record::id));
+  CHECK(!hc.template find<record>(std::pair{&record::id, 5}).first);
+  hc.push_back(record{7, "h"});
+  CHECK(hc.template find<record>(std::pair{&record::id, 7}).first);
+}
+
+struct checked_record {
+  int id;
+
+  [[nodiscard]] int key() const {
+    if(id < 0) {
+      throw std::invalid_argument("negative key");
+    }
+    return id;
+  }
+  bool operator==(checked_record const &) const = default;
+};
+
+TEST_CASE_TEMPLATE("failed insertion bookkeeping test", HC, het::hvector, het::hdeque) {
+  // the element whose index entry can't be made is erased again, the indexes and the insertion order are kept intact
+  using record = checked_record;
+  HC hc;
+  hc.keep_insertion_order();
+  hc.push_back(record{1}, record{2}, 3);
+  hc.template create_index<record>(&record::id);
+  hc.template create_ordered_index<record>(&record::key);
+  CHECK_THROWS_AS(hc.insert(hc.template fraction<record>().begin(), record{-1}), std::invalid_argument);
+  CHECK_THROWS_AS(hc.template emplace_back<record>(-2), std::invalid_argument);
+  CHECK(hc.size() == 3);
+  CHECK(hc.template fraction<record>().size() == 2);
+  CHECK(!hc.template contains<record>(std::pair{&record::id, -1}));
+  CHECK(hc.template find<record>(std::pair{&record::id, 1}).second == hc.template fraction<record>().begin());
+  CHECK(het::query_first<record>(hc, std::pair{&record::key, 2}).second->id == 2);
+
+  hc.insert(hc.template fraction<record>().begin(), record{0});
+  std::stringstream ss;
+  hc.template ordered_visit<record, int>()([&ss](auto const & v) {
+    if constexpr(std::is_same_v<std::remove_cvref_t<decltype(v)>, record>) {
+      ss << v.id << ' ';
+    } else {
+      ss << 'i' << v << ' ';
+    }
+    return het::VisitorReturn::Continue;
+  });
+  CHECK(ss.str() == "1 2 i3 0 ");
+  CHECK(hc.template find<record>(std::pair{&record::id, 2}).second == std::next(hc.template fraction<record>().begin(), 2));
+  CHECK(het::query_first<record>(hc, std::pair{&record::key, 0}).second == hc.template fraction<record>().begin());
+}
+
+TEST_CASE_TEMPLATE("throwing erase_if predicate test", HC, het::hvector, het::hdeque) {
+  // the elements picked before the predicate throws are erased, the rest are kept and stay indexed
+  using record = checked_record;
+  HC hc;
+  hc.keep_insertion_order();
+  hc.push_back(record{1}, record{2}, 0, record{3}, record{4}, record{5}, record{6});
+  hc.template create_index<record>(&record::id);
+  hc.template create_ordered_index<record>(&record::key);
+  CHECK_THROWS_AS(hc.template erase_if<record>([](record const & r) {
+    if(r.id == 4) {
+      throw std::runtime_error("predicate");
+    }
+    return r.id % 2 == 1;
+  }), std::runtime_error);
+  CHECK(hc.size() == 5);
+  CHECK(hc.template count_of<record>() == 4);
+  CHECK(!hc.template contains<record>(std::pair{&record::id, 3}));
+  CHECK(hc.template find<record>(std::pair{&record::id, 5}).second == std::next(hc.template fraction<record>().begin(), 2));
+  CHECK(het::query_first<record>(hc, std::pair{&record::key, 6}).second == std::next(hc.template fraction<record>().begin(), 3));
+  std::stringstream ss;
+  hc.template ordered_visit<record, int>()([&ss](auto const & v) {
+    if constexpr(std::is_same_v<std::remove_cvref_t<decltype(v)>, record>) {
+      ss << v.id << ' ';
+    } else {
+      ss << 'i' << v << ' ';
+    }
+    return het::VisitorReturn::Continue;
+  });
+  CHECK(ss.str() == "2 i0 4 5 6 ");
+}
+
+TEST_CASE("hash index storage test") {
+  using record = indexed_record;
+  CHECK_THROWS_AS(het::hslot_map{}.create_index<record>(&record::id), std::logic_error);
+
+  // the index and its entries are allocated from the resource of the container
+  struct counting_resource : std::pmr::memory_resource {
+    std::size_t bytes = 0;
+    void * do_allocate(std::size_t n, std::size_t align) override {
+      bytes += n;
+      return std::pmr::new_delete_resource()->allocate(n, align);
+    }
+    void do_deallocate(void * p, std::size_t n, std::size_t align) override {
+      bytes -= n;
+      std::pmr::new_delete_resource()->deallocate(p, n, align);
+    }
+    [[nodiscard]] bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override {
+      return this == &other;
+    }
+  } counting, counting1;
+  {
+    het::hvector hc(&counting);
+    for(int i = 0; i < 100; ++i) {
+      hc.push_back(record{i, "r"});
+    }
+    auto before = counting.bytes;
+    hc.create_index<record>(&record::id);
+    CHECK(counting.bytes - before >= 100 * sizeof(std::size_t));
+    het::hvector hc1(hc, &counting1);
+    CHECK(counting1.bytes > counting.bytes - before);
+    hc.clear();
+    hc = std::move(hc1);
+    CHECK(hc.find<record>(std::pair{&record::id, 42}).first);
+  }
+  CHECK(counting.bytes == 0);
+  CHECK(counting1.bytes == 0);
+}
+
+struct timed_record {
+  long ts;
+  double price;
+  std::string name;
+
+  bool operator==(timed_record const &) const = default;
+};
+
+TEST_CASE_TEMPLATE("ordered index test", HC, het::hvector, het::hdeque, het::hash_key_container<std::vector>) {
+  using record = timed_record;
+  auto names = [](auto && range) {
+    std::string s;
+    for(auto && e : range) {
+      s += e.name;
+    }
+    return s;
+  };
+  HC hc;
+  hc.template create_ordered_index<record>(&record::ts);
+  CHECK(hc.template has_index<record>(&record::ts));
+  hc.push_back(record{10, 1., "a"}, record{30, 2., "b"}, record{20, 3., "c"}, record{40, 4., "d"}, record{30, 5., "e"});
+  CHECK(names(het::query_range<record>(hc, &record::ts, 20L, 30L)) == "cbe");
+  CHECK(names(het::query_range<record>(hc, het::lt(&record::ts, 30L))) == "ac");
+  CHECK(names(het::query_range<record>(hc, het::le(&record::ts, 10L))) == "a");
+  CHECK(names(het::query_range<record>(hc, het::gt(&record::ts, 30L))) == "d");
+  CHECK(names(het::query_range<record>(hc, het::ge(&record::ts, 30L))) == "bed");
+  CHECK(names(het::query_range<record>(hc, std::pair{&record::ts, 30L})) == "be");
+  CHECK(names(het::query_range<record>(hc, het::between(&record::ts, 30L, 20L))).empty());
+  CHECK_THROWS_AS(het::query_range<record>(hc, &record::price, 0., 1.), std::logic_error);
+
+  CHECK(het::query_first<record>(hc, het::ge(&record::ts, 30L)).second->name == "b");
+  CHECK(het::query_last<record>(hc, het::ge(&record::ts, 30L)).second->name == "e");
+  CHECK(het::query_first<record>(hc, het::gt(&record::ts, 10L), std::pair{&record::name, "d"s}).second->name == "d");
+  CHECK(het::query_first<record>(hc, het::between(&record::price, 2.5, 3.5)).second->name == "c"); // scan
+  CHECK(!het::query_first<record>(hc, het::gt(&record::ts, 40L)).first);
+  CHECK(hc.template contains<record>(het::between(&record::ts, 35, 45)));
+  CHECK(hc.template find<record>(std::pair{&record::ts, 20L}).second->name == "c");
+
+  hc.insert(hc.template fraction<record>().begin(), record{5, 0., "f"});
+  hc.template erase<record>(2);
+  CHECK(names(het::query_range<record>(hc, &record::ts, 0L, 100L)) == "faced");
+  hc.template erase_if<record>([](record const & r) { return r.name == "c"; });
+  hc.template append_range<record>(std::vector{record{25, 0., "g"}, record{1, 0., "h"}});
+  CHECK(names(het::query_range<record>(hc, &record::ts, 0L, 100L)) == "hfaged");
+  HC hc1(hc);
+  CHECK(names(het::query_range<record>(hc1, het::ge(&record::ts, 25L))) == "ged");
+  hc.template modify<record>(hc.template fraction<record>().begin(), [](record & r) { r.ts = 35; });
+  CHECK(names(het::query_range<record>(hc, &record::ts, 0L, 100L)) == "hagefd");
+  CHECK(names(het::query_range<record>(hc, het::gt(&record::ts, 30L))) == "fd");
+  hc.clear();
+  CHECK(names(het::query_range<record>(hc, &record::ts, 0L, 100L)).empty());
+}
+
+TEST_CASE("query expression test") {
+  using record = timed_record;
+  using het::field;
+  het::hvector hc(record{10, 1., "a"}, record{30, 2., "b"}, record{20, 3., "c"}, record{40, 4., "d"}, record{30, 5., "e"});
+
+  auto q = het::where(field(&record::ts) == 30L && field(&record::price) > 3.);
+  static_assert(std::tuple_size_v<decltype(q.clauses())> == 2);
+  static_assert(std::tuple_size_v<decltype(het::where(field(&record::ts) != 1L || field(&record::ts) == 2L).clauses())> == 0);
+  CHECK(het::query_first<record>(hc, q).second->name == "e");
+  CHECK(het::find_first<record>(hc, q).second->name == "e");
+  CHECK(het::find_first<record>(hc, het::where(field(&record::name) == "a"s)).first);
+  CHECK(het::query_last<record>(hc, het::where(!(field(&record::name) != "b"s))).second->price == 2.);
+  CHECK(!het::query_first<record>(hc, het::where(field(&record::ts) > 40L)).first);
+  std::vector<record> out;
+  CHECK(het::find_all<record>(hc, std::back_inserter(out), het::where(field(&record::ts) < 20L || field(&record::name) == "d"s)));
+  CHECK(out.size() == 2);
+
+  hc.create_index<record>(&record::ts);
+  CHECK(het::query_first<record>(hc, het::where(field(&record::ts) == 30L && field(&record::name) == "e"s)).second->price == 5.);
+  hc.create_ordered_index<record>(&record::price);
+  auto in_range = het::where(field(&record::price) >= 2. && field(&record::price) < 4.);
+  CHECK(het::query_first<record>(hc, in_range).second->name == "b");
+  CHECK(het::query_last<record>(hc, in_range).second->name == "c");
+  CHECK(hc.erase_if<record>(het::where(field(&record::ts) >= 30L)) == 3);
+  CHECK(hc.size() == 2);
+  CHECK(het::query_first<record>(hc, het::where(field(&record::ts) == 20L)).second->name == "c");
+}
+
+// checks every kernel the CPU runs against the predicate called per element
+template <typename T, typename E> void check_scan_kernels(std::vector<T> const & values, E const & expression) {
+  auto p = het::details::scan_recognizer<T, E>::of(expression);
+  REQUIRE(p.has_value());
+  auto first = static_cast<std::size_t>(std::ranges::find_if(values, expression) - values.begin());
+  std::vector<std::uint64_t> expected((values.size() + 63) / 64);
+  for(std::size_t i = 0; i < values.size(); ++i) {
+    expected[i / 64] |= std::uint64_t{expression(values[i])} << (i % 64);
+  }
+  auto isas = {het::details::scan_isa::scalar, het::details::scan_isa::sse2, het::details::scan_isa::avx2};
+  for(auto isa : isas) {
+    if(isa > het::details::detected_scan_isa()) {
+      continue;
+    }
+    std::vector<std::uint64_t> bits(expected.size());
+    CHECK(het::details::scan(values.data(), values.size(), *p, nullptr, isa) == first);
+    het::details::scan(values.data(), values.size(), *p, bits.data(), isa);
+    CHECK(bits == expected);
+  }
+}
+
+TEST_CASE("simd scan test") {
+  using het::element;
+  auto generate = []<typename T>(std::size_t n, T) {
+    std::vector<T> values(n);
+    for(std::size_t i = 0; i < n; ++i) {
+      values[i] = static_cast<T>(static_cast<int>((i * 7919) % 61) - 30);
+    }
+    return values;
+  };
+  for(std::size_t n : {0, 1, 7, 31, 64, 100, 1000}) {
+    auto ints = generate(n, int{});
+    check_scan_kernels(ints, het::where(element() == 17));
+    check_scan_kernels(ints, het::where(element() != -30));
+    check_scan_kernels(ints, het::where(element() >= -5 && element() < 5));
+    check_scan_kernels(ints, het::where(!(element() > 0)));
+    check_scan_kernels(ints, het::where(element() > 100));
+    auto chars = generate(n, char{});
+    check_scan_kernels(chars, het::where(element() <= char{-29}));
+    check_scan_kernels(chars, het::where(element() > char{0} && element() <= char{3}));
+    auto doubles = generate(n, double{});
+    auto floats = generate(n, float{});
+    if(n > 3) {
+      doubles[3] = std::numeric_limits<double>::quiet_NaN();
+      floats[3] = std::numeric_limits<float>::quiet_NaN();
+    }
+    check_scan_kernels(doubles, het::where(element() >= 29.));
+    check_scan_kernels(doubles, het::where(!(element() >= -1. && element() <= 1.)));
+    check_scan_kernels(floats, het::where(element() != 2.f));
+    check_scan_kernels(floats, het::where(element() < -10.f));
+  }
+
+  // clauses of the range bounds leave NaN in range as the scalar !(x < lo) does
+  std::vector<double> nans{1., std::numeric_limits<double>::quiet_NaN(), 3.};
+  auto clause = het::ge(std::identity{}, 2.);
+  auto p = het::details::scan_recognizer<double, decltype(clause)>::of(clause);
+  CHECK(het::details::scan(nans.data(), nans.size(), *p, nullptr) == 1);
+  CHECK(!het::details::scan_recognizer<double, decltype(het::where(element() == 1))>::value);
+  CHECK(!het::details::scan_recognizer<double, decltype(het::where(element() < 1. || element() > 2.))>::value);
+
+  het::hvector hc;
+  for(int i = 0; i < 300; ++i) {
+    hc.push_back(i % 50);
+    hc.push_back(static_cast<float>(i) / 2.f);
+  }
+  hc.push_back("x"s);
+  auto [found, it] = het::find_first<int>(hc, het::where(element() > 47));
+  CHECK(found);
+  CHECK(*it == 48);
+  CHECK(!het::find_first<int>(hc, het::where(element() > 50)).first);
+  CHECK(het::query_first<float>(hc, het::where(element() >= 10.f)).second == std::next(hc.fraction<float>().begin(), 20));
+  std::vector<int> ints;
+  CHECK(het::find_all<int>(hc, std::back_inserter(ints), het::where(element() < 2)));
+  CHECK(ints == std::vector<int>{0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1});
+  CHECK(!het::find_all<int>(hc, std::back_inserter(ints), het::where(element() < -2)));
+  auto bits = het::match_bitmap<float>(hc, het::where(element() < 1.f));
+  CHECK(bits.size() == 5);
+  CHECK(bits[0] == 0b11);
+  CHECK(het::match_bitmap<std::string>(hc, [](auto const & s) { return s == "x"; }) == std::vector<std::uint64_t>{1});
+  CHECK(hc.contains<int>(std::pair{std::identity{}, 49}));
+  CHECK(!hc.contains<int>(std::pair{std::identity{}, 50}));
+  CHECK(hc.find<float>(het::between(std::identity{}, 3.2f, 3.7f)).second == std::next(hc.fraction<float>().begin(), 7));
+}
+
+TEST_CASE("work-stealing task scheduler test") {
+  for(std::size_t workers : {0, 1, 3}) {
+    het::task_scheduler scheduler(workers);
+    CHECK(scheduler.concurrency() == workers + 1);
+    std::vector<int> hits(100'000);
+    scheduler.parallel_for(0, hits.size(), 1000, [&hits](std::size_t first, std::size_t last) {
+      for(; first < last; ++first) {
+        ++hits[first];
+      }
+    });
+    CHECK(std::ranges::all_of(hits, [](int h) { return h == 1; }));
+
+    // nested fork/join, the waiting threads run the inner chunks
+    std::atomic<std::size_t> total{0};
+    scheduler.parallel_for(0, 8, 1, [&](std::size_t first, std::size_t last) {
+      for(; first < last; ++first) {
+        scheduler.parallel_for(0, 1000, 10, [&total](std::size_t b, std::size_t e) { total += e - b; });
+      }
+    });
+    CHECK(total == 8000);
+
+    CHECK_THROWS_AS(scheduler.parallel_for(0, 1000, 1, [](std::size_t first, std::size_t) {
+      if(first == 500) {
+        throw std::runtime_error("chunk failure");
+      }
+    }), std::runtime_error);
+    scheduler.parallel_for(5, 5, 1, [](std::size_t, std::size_t) { FAIL("empty range"); });
+    std::vector<std::pair<std::size_t, std::size_t>> chunks;
+    scheduler.parallel_for(5, 10, std::numeric_limits<std::size_t>::max(), [&chunks](std::size_t first, std::size_t last) {
+      chunks.emplace_back(first, last);
+    });
+    CHECK(chunks == std::vector<std::pair<std::size_t, std::size_t>>{{5, 10}});
+  }
+  CHECK(&het::task_scheduler::shared() == &het::task_scheduler::shared());
+}
+
+TEST_CASE("parallel visit and match test") {
+  het::hvector hc;
+  hc.append_range<int>(std::views::iota(1, 10'001));
+  hc.append_range<double>(std::views::iota(1, 101) | std::views::transform([](int i) { return i * .5; }));
+  hc.push_back("a"s, "bc"s);
+  het::task_scheduler scheduler(3);
+  het::parallel_policy policy{&scheduler, 64};
+
+  std::atomic<long> ints{0};
+  std::atomic<int> doubles{0};
+  CHECK(hc.visit_par<int, double>(policy)([&](auto const & e) {
+    if constexpr(std::same_as<std::remove_cvref_t<decltype(e)>, int>) {
+      ints += e;
+    } else {
+      doubles += 1;
+    }
+    return het::VisitorReturn::Continue;
+  }) == het::VisitorReturn::Continue);
+  CHECK(ints == 50'005'000);
+  CHECK(doubles == 100);
+
+  // Break cancels the run, the chunks not yet taken are skipped
+  std::atomic<int> visited{0};
+  CHECK(hc.visit_par<int>(het::parallel_policy{&scheduler, 16})([&](int i) {
+    ++visited;
+    return i == 1 ? het::VisitorReturn::Break : het::VisitorReturn::Continue;
+  }) == het::VisitorReturn::Break);
+  CHECK(visited < 10'000);
+
+  std::atomic<std::size_t> chars{0};
+  std::atomic<int> halves{0};
+  CHECK(hc.match_par<std::string, double>(policy)(
+      [&](std::string const & s) { chars += s.size(); },
+      [&](double d) { halves += static_cast<int>(d * 2); }));
+  CHECK(chars == 3);
+  CHECK(halves == 5050);
+  CHECK(!hc.match_par<float, double>()([](auto const &) {}));
+
+  CHECK_THROWS_AS(hc.visit_par<int>(policy)([](int i) {
+    if(i == 5'000) {
+      throw std::runtime_error("visitor failure");
+    }
+    return het::VisitorReturn::Continue;
+  }), std::runtime_error);
+  CHECK(het::hvector{}.visit_par<int>()([](int) { return het::VisitorReturn::Break; }) == het::VisitorReturn::Continue);
+}
+
+TEST_CASE("parallel find_all and count_if test") {
+  using het::element;
+  het::hvector hc;
+  hc.append_range<int>(std::views::iota(0, 100'000) | std::views::transform([](int i) { return i * 7919 % 1000; }));
+  hc.append_range<std::string>(std::views::iota(0, 1000) | std::views::transform([](int i) { return std::to_string(i); }));
+  het::task_scheduler scheduler(3);
+  het::parallel_policy policy{&scheduler, 1000};
+
+  auto even = [](int i) { return i % 10 == 0; };
+  std::vector<int> sequential, parallel;
+  CHECK(het::find_all<int>(hc, std::back_inserter(sequential), even));
+  CHECK(het::find_all<int>(hc, policy, std::back_inserter(parallel), even));
+  CHECK(parallel == sequential);
+  parallel.clear();
+  // a grain of one element is coarsened to a few chunks per thread, the order is kept
+  CHECK(het::find_all<int>(hc, het::parallel_policy{&scheduler, 1}, std::back_inserter(parallel), even));
+  CHECK(parallel == sequential);
+  parallel.clear();
+  CHECK(het::find_all<int>(hc, policy, std::back_inserter(parallel), het::where(element() < 100 && element() >= 0)));
+  CHECK(parallel.size() == 10'000);
+  CHECK(std::ranges::all_of(parallel, [](int i) { return i < 100; }));
+
+  policy.ordered = false;
+  parallel.clear();
+  CHECK(het::find_all<int>(hc, policy, std::back_inserter(parallel), even));
+  CHECK(parallel.size() == sequential.size());
+  std::ranges::sort(parallel);
+  std::ranges::sort(sequential);
+  CHECK(parallel == sequential);
+  std::vector<std::string> strings;
+  CHECK(het::find_all<std::string>(hc, policy, std::back_inserter(strings), [](auto const & s) { return s.size() == 1; }));
+  CHECK(strings.size() == 10);
+  std::vector<double> doubles;
+  CHECK(!het::find_all<double>(hc, policy, std::back_inserter(doubles), [](double) { return true; }));
+  CHECK(!het::find_all<int>(hc, policy, std::back_inserter(parallel), [](int i) { return i < 0; }));
+
+  CHECK(het::count_if<int>(hc, even) == sequential.size());
+  CHECK(het::count_if<int>(hc, policy, even) == sequential.size());
+  CHECK(het::count_if<int>(hc, het::where(element() == 999)) == 100);
+  CHECK(het::count_if<int>(hc, policy, het::where(element() > 499)) == 50'000);
+  CHECK(het::count_if<std::string>(hc, policy, [](auto const & s) { return s.starts_with("9"); }) == 111);
+  CHECK(het::count_if<float>(hc, policy, [](float) { return true; }) == 0);
+
+  policy.grain = 0;
+  het::hvector few(10, 2, 30, 4, 5);
+  CHECK(het::count_if<int>(few, policy, even) == 2);
+
+  // the largest grain keeps the fraction in a single chunk
+  policy.grain = std::numeric_limits<std::size_t>::max();
+  policy.ordered = true;
+  parallel.clear();
+  CHECK(het::find_all<int>(few, policy, std::back_inserter(parallel), even));
+  CHECK(parallel == std::vector{10, 30});
+  CHECK(het::count_if<int>(few, policy, even) == 2);
+}
+
+TEST_CASE("lazy views over fractions test") {
+  het::hvector hc;
+  hc.append_range<int>(std::views::iota(0, 20));
+  hc.push_back(1.5, "a"s, 2.5, "bc"s);
+
+  auto ints = hc.view<int>();
+  static_assert(std::ranges::view<decltype(ints)> && std::ranges::contiguous_range<decltype(ints)>);
+  auto picked = ints | std::views::filter([](int i) { return i % 2 == 0; })
+                     | std::views::filter([](int i) { return i % 3 == 0; })
+                     | std::views::transform([](int i) { return i * 10; })
+                     | std::views::take(3);
+  CHECK(std::ranges::equal(picked, std::vector{0, 60, 120}));
+  for(auto & i : hc.view<int>() | std::views::take(2)) {
+    i += 100;
+  }
+  CHECK(hc.fraction<int>()[1] == 101);
+  CHECK(std::as_const(hc).view<double>().size() == 2);
+  CHECK(hc.view<float>().empty());
+
+  auto joined = std::as_const(hc).joined_view<std::string, double, float>();
+  static_assert(std::ranges::forward_range<decltype(joined)> && std::ranges::view<decltype(joined)>);
+  static_assert(std::ranges::borrowed_range<decltype(joined)>);
+  CHECK(joined.size() == 4);
+  std::ostringstream os;
+  for(auto e : joined) {
+    std::visit([&os](auto ref) { os << ref.get() << ","; }, e);
+  }
+  CHECK(os.str() == "a,bc,1.5,2.5,");
+  auto strings = joined | std::views::filter([](auto const & e) { return e.index() == 0; });
+  CHECK(std::ranges::distance(strings) == 2);
+  CHECK(std::get<1>(*std::ranges::next(joined.begin(), 3)).get() == 2.5);
+
+  auto mutable_joined = hc.joined_view<float, double>();
+  for(auto e : mutable_joined) {
+    std::get<1>(e).get() *= 2;
+  }
+  CHECK(hc.fraction<double>()[1] == 5.);
+  CHECK(hc.joined_view<float, char>().begin() == std::default_sentinel);
+}
+
+TEST_CASE("coroutine generator test") {
+  het::hvector hc;
+  hc.append_range<int>(std::views::iota(0, 10));
+  hc.push_back("a"s, 1.5, "b"s);
+
+  auto gen = hc.generate<int, std::string>();
+  static_assert(std::ranges::input_range<decltype(gen)>);
+  std::vector<int> ints;
+  for(auto e : gen | std::views::take(4)) {
+    ints.push_back(std::get<0>(e));
+  }
+  CHECK(ints == std::vector{0, 1, 2, 3});
+  // the next pass continues where the previous one stopped
+  std::string joined;
+  for(auto e : gen) {
+    std::visit([&](auto const & v) {
+      if constexpr(std::same_as<std::remove_cvref_t<decltype(v.get())>, std::string>) {
+        joined += v.get();
+      } else {
+        joined += std::to_string(v.get());
+      }
+    }, e);
+  }
+  CHECK(joined == "456789ab");
+  CHECK(gen.begin() == std::default_sentinel);
+  CHECK(hc.generate<float>().begin() == std::default_sentinel);
+  CHECK(het::generator<int>().begin() == std::default_sentinel);
+
+  std::vector<std::size_t> sizes;
+  int sum = 0;
+  for(auto batch : hc.generate_batches<int, double>(4)) {
+    sizes.push_back(batch.size());
+    for(auto e : batch) {
+      sum += e.index() == 0 ? std::get<0>(e).get() : 1000;
+    }
+  }
+  CHECK(sizes == std::vector<std::size_t>{4, 4, 3});
+  CHECK(sum == 1045);
+
+  // the frames come from the arena, the default resource isn't touched
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  auto doubles = hc.generate<double>(&arena);
+  auto batches = hc.generate_batches<int>(3, &arena);
+  CHECK(std::get<0>(*doubles.begin()).get() == 1.5);
+  CHECK((*batches.begin()).size() == 3);
+  CHECK(std::ranges::distance(batches) == 4);
+
+  het::generator<int> thrower = [](std::allocator_arg_t, std::pmr::memory_resource *) -> het::generator<int> {
+    co_yield 1;
+    throw std::runtime_error("generator failure");
+  }(std::allocator_arg, &arena);
+  auto it = thrower.begin();
+  CHECK(*it == 1);
+  CHECK_THROWS_AS(++it, std::runtime_error);
+  CHECK(it == std::default_sentinel);
+}
+
+struct join_order {
+  int id;
+  int quantity;
+};
+
+struct join_fill {
+  long order_id;
+  int quantity;
+
+  [[nodiscard]] long order() const { return order_id; }
+};
+
+TEST_CASE_TEMPLATE("multi-type find_first and hash join test", HC, het::hvector, het::hdeque, het::hslot_map) {
+  HC hc;
+  hc.push_back(join_order{1, 10}, join_order{2, 20}, join_order{3, 30});
+  hc.push_back(join_fill{2, 5}, join_fill{1, 10}, join_fill{2, 15}, join_fill{4, 1});
+  hc.push_back('x');
+
+  auto [found, its] = het::find_first<join_order, join_fill, char>(hc, [](join_order const & o, join_fill const & f, char) {
+    return o.id == f.order_id && o.quantity > f.quantity;
+  });
+  CHECK(found);
+  CHECK(std::get<0>(its)->id == 2);
+  CHECK(std::get<1>(its)->quantity == 5);
+  CHECK(!het::find_first<join_order, join_fill>(hc, [](auto const & o, auto const & f) { return o.id + f.order_id > 100; }).first);
+  CHECK(!het::find_first<join_order, double>(hc, [](auto const &, double) { return true; }).first);
+
+  auto [filled, pair] = het::find_first<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id,
+                                                               [](join_order const & o, join_fill const & f) { return o.quantity == f.quantity; });
+  CHECK(filled);
+  CHECK(std::get<0>(pair)->id == 1);
+  CHECK(std::get<1>(pair)->quantity == 10);
+  CHECK(!het::find_first<join_order, join_fill>(hc, &join_order::id, &join_fill::order, [](auto const &, auto const &) { return false; }).first);
+
+  auto summary = [](auto const & pairs) {
+    std::vector<std::pair<int, int>> result;
+    for(auto [o, f] : pairs) {
+      result.emplace_back(o->id, f->quantity);
+    }
+    return result;
+  };
+  auto expected = std::vector<std::pair<int, int>>{{1, 10}, {2, 5}, {2, 15}};
+  CHECK(summary(het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id)) == expected);
+  // the build side is the smaller fraction, the pairs go in the order of the first type anyway
+  CHECK(summary(het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order)) == expected);
+  hc.push_back(join_order{5, 50}, join_order{6, 60});
+  CHECK(summary(het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id)) == expected);
+  CHECK(summary(het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id,
+                                                [](auto const &, join_fill const & f) { return f.quantity > 5; })) ==
+        std::vector<std::pair<int, int>>{{1, 10}, {2, 15}});
+  CHECK(het::join<join_order, double>(hc, &join_order::id, [](double d) { return static_cast<int>(d); }).empty());
+}
+
+TEST_CASE("hash join through the indexes test") {
+  // the hash indexes serve the build side
+  het::hvector hc;
+  for(int i = 0; i < 100; ++i) {
+    hc.push_back(join_order{i, i});
+    hc.push_back(join_fill{99 - i, i}, join_fill{i, i});
+  }
+  auto plain = het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id);
+  CHECK(plain.size() == 200);
+  CHECK(std::ranges::is_sorted(plain, {}, [](auto const & p) { return p.first->id; }));
+  hc.create_index<join_fill>(&join_fill::order_id);
+  CHECK(het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id) == plain);
+  hc.create_index<join_order>(&join_order::id);
+  CHECK(het::join<join_order, join_fill>(hc, &join_order::id, &join_fill::order) == plain);
+  CHECK(std::get<1>(het::find_first<join_order, join_fill>(hc, &join_order::id, &join_fill::order_id,
+                                                           [](auto const &, join_fill const & f) { return f.quantity > 50; }).second)->quantity == 99);
+}
+
+TEST_CASE("concurrent registry container test") {
+  constexpr int threads_count = 8;
+  constexpr int rounds = 200;
+  std::vector<std::size_t> sizes(threads_count);
+  std::vector<std::thread> threads;
+  for(int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([t, &sizes] {
+      for(int r = 0; r < rounds; ++r) {
+        het::concurrent_key_container<std::vector> hc(int{t}, int{r}, "foo"s);
+        hc.push_back(1.);
+        auto hc1 = hc;
+        auto hc2 = std::move(hc);
+        hc2.template erase<double>(0);
+        sizes[t] += hc1.size() + hc2.size();
+      }
+    });
+  }
+  for(auto & thread : threads) {
+    thread.join();
+  }
+  for(auto sz : sizes) {
+    CHECK(sz == rounds * 7);
+  }
+}
+
+TEST_CASE("registry and indexed storage based containers test") {
+  het::hash_key_container<std::vector> hr;
+  het::hvector hi;
+  CHECK(hr.empty());
+  CHECK(hi.empty());
+
+  hr.push_back(1, 2.0, 'c', 3);
+  hi.push_back(1, 2.0, 'c', 3);
+
+  CHECK(hr.size() == 4);
+  CHECK(hi.size() == 4);
+  CHECK(hr.fraction<int>() == hi.fraction<int>());
+  CHECK(hr.contains<double>());
+  CHECK(hi.contains<double>());
+  CHECK(!hr.contains<float>());
+  CHECK(!hi.contains<float>());
+  CHECK_THROWS_AS(hi.fraction<float>(), std::out_of_range);
+
+  het::hvector hc = hi;
+  hi.clear();
+  CHECK(hi.empty());
+  CHECK(hi.size() == 0);
+  CHECK(!hi.contains<int>());
+  CHECK(hc.size() == 4);
+  CHECK(hc.at<int>(1) == 3);
+
+  hi.push_back(5);
+  CHECK(hi.size() == 1);
+  CHECK(hi.at<int>(0) == 5);
+}
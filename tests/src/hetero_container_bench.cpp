@@ -6,6 +6,16 @@
 
 #include "het/het.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory_resource>
+#include <ranges>
+#include <thread>
+#include <variant>
+#include <vector>
+
 using namespace std::string_view_literals;
 using namespace std::string_literals;
 
@@ -58,6 +68,56 @@ static void het_container_push_back_tuple(benchmark::State& state) {
 // Register the function as a benchmark
 BENCHMARK(het_container_push_back_tuple);
 
+static void het_registry_container_push_back_tuple(benchmark::State& state) {
+  het::hash_key_container<std::vector> values;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    values.push_back(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_registry_container_push_back_tuple);
+
+static void het_container_short_lived(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector values;
+    values.push_back(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_short_lived);
+
+static void het_container_short_lived_arena(benchmark::State& state) {
+  std::array<std::byte, 4096> buffer;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    het::pmr_hvector values(&arena);
+    values.push_back(1, 1.2f, 3., 'c', "stringview"sv, std::pmr::string{"string"});
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_short_lived_arena);
+
+static void het_registry_container_short_lived(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hash_key_container<std::vector> values;
+    values.push_back(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_registry_container_short_lived);
+
 static void tuple_container_push_back_tuple(benchmark::State& state) {
   std::vector<std::tuple<int, float, double, char, std::string_view, std::string>> values;
   // Code inside this loop is measured repeatedly
@@ -70,6 +130,18 @@ static void tuple_container_push_back_tuple(benchmark::State& state) {
 // Register the function as a benchmark
 BENCHMARK(tuple_container_push_back_tuple);
 
+static void static_container_push_back_tuple(benchmark::State& state) {
+  het::svector<int, float, double, char, std::string_view, std::string> values;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    values.push_back(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(static_container_push_back_tuple);
+
 static void het_container_access(benchmark::State& state) {
   het::hvector values;
   // Code inside this loop is measured repeatedly
@@ -105,6 +177,278 @@ static void het_container_access(benchmark::State& state) {
 // Register the function as a benchmark
 BENCHMARK(het_container_access);
 
+static void het_container_at_access(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1024; ++i) {
+    values.push_back(int{i}, 1.2f, 3.);
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    for(std::size_t l = 0; l < 1024; ++l) {
+      auto i = values.at<int>(l);
+      auto f = values.at<float>(l);
+      auto d = values.at<double>(l);
+      // Make sure the variable is not optimized away by compiler
+      benchmark::DoNotOptimize(i);
+      benchmark::DoNotOptimize(f);
+      benchmark::DoNotOptimize(d);
+    }
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_at_access);
+
+static void het_container_handle_access(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1024; ++i) {
+    values.push_back(int{i}, 1.2f, 3.);
+  }
+  auto hi = values.handle<int>();
+  auto hf = values.handle<float>();
+  auto hd = values.handle<double>();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    for(std::size_t l = 0; l < hi.size(); ++l) {
+      auto i = hi[l];
+      auto f = hf[l];
+      auto d = hd[l];
+      // Make sure the variable is not optimized away by compiler
+      benchmark::DoNotOptimize(i);
+      benchmark::DoNotOptimize(f);
+      benchmark::DoNotOptimize(d);
+    }
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_handle_access);
+
+struct bench_record {
+  int id;
+  double value;
+};
+
+static void het_container_query_scan(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1'000'000; ++i) {
+    values.emplace_back<bench_record>(i, 1.);
+  }
+  int id = 0;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::query_first<bench_record>(values, std::pair{&bench_record::id, id});
+    id = (id + 7919) % 1'000'000;
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_query_scan);
+
+static void het_container_query_index(benchmark::State& state) {
+  het::hvector values;
+  values.create_index<bench_record>(&bench_record::id);
+  for(int i = 0; i < 1'000'000; ++i) {
+    values.emplace_back<bench_record>(i, 1.);
+  }
+  int id = 0;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::query_first<bench_record>(values, std::pair{&bench_record::id, id});
+    id = (id + 7919) % 1'000'000;
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_query_index);
+
+static void het_container_query_clauses(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1'000'000; ++i) {
+    values.emplace_back<bench_record>(i, i % 2);
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::query_first<bench_record>(values, std::pair{&bench_record::value, 1.}, std::pair{&bench_record::id, 999'999});
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_query_clauses);
+
+static void het_container_query_expression(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1'000'000; ++i) {
+    values.emplace_back<bench_record>(i, i % 2);
+  }
+  auto query = het::where(het::field(&bench_record::value) == 1. && het::field(&bench_record::id) == 999'999);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::query_first<bench_record>(values, query);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_query_expression);
+
+// 10M-element fractions of pseudo-random values within [0, 1000)
+static het::hvector scan_fractions() {
+  het::hvector values;
+  auto generated = std::views::iota(0, 10'000'000) | std::views::transform([](int i) { return static_cast<int>(i * 7919LL % 1000); });
+  values.append_range<int>(generated);
+  values.append_range<float>(generated | std::views::transform([](int i) { return static_cast<float>(i) / 10.f; }));
+  return values;
+}
+
+static void het_container_scan_first_scalar(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::find_first<int>(values, [](int v) { return v > 1000; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_scan_first_scalar);
+
+static void het_container_scan_first_simd(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::find_first<int>(values, het::where(het::element() > 1000));
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_scan_first_simd);
+
+static void het_container_scan_all_scalar(benchmark::State& state) {
+  auto values = scan_fractions();
+  std::vector<float> out;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    out.clear();
+    het::find_all<float>(values, std::back_inserter(out), [](float v) { return v >= 10.f && v < 11.f; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(out);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_scan_all_scalar);
+
+static void het_container_scan_all_simd(benchmark::State& state) {
+  auto values = scan_fractions();
+  std::vector<float> out;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    out.clear();
+    het::find_all<float>(values, std::back_inserter(out), het::where(het::element() >= 10.f && het::element() < 11.f));
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(out);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_scan_all_simd);
+
+static void het_container_match_bitmap(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto bits = het::match_bitmap<float>(values, het::where(het::element() >= 10.f && het::element() < 11.f));
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(bits);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_match_bitmap);
+
+static void het_container_pipeline_materialized(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::vector<int> stage1, stage2, stage3;
+    het::find_all<int>(values, std::back_inserter(stage1), [](int v) { return v % 2 == 0; });
+    std::ranges::copy_if(stage1, std::back_inserter(stage2), [](int v) { return v % 3 == 0; });
+    std::ranges::copy_if(stage2, std::back_inserter(stage3), [](int v) { return v > 500; });
+    long sum = 0;
+    for(auto v : stage3) {
+      sum += v;
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_pipeline_materialized)->Unit(benchmark::kMillisecond);
+
+static void het_container_pipeline_view(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    long sum = 0;
+    for(auto v : values.view<int>() | std::views::filter([](int v) { return v % 2 == 0; })
+                                    | std::views::filter([](int v) { return v % 3 == 0; })
+                                    | std::views::filter([](int v) { return v > 500; })) {
+      sum += v;
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_pipeline_view)->Unit(benchmark::kMillisecond);
+
+static void het_container_visit_sum(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    double sum = 0;
+    values.visit<int, float>()([&](auto v) { sum += static_cast<double>(v); return het::VisitorReturn::Continue; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_visit_sum)->Unit(benchmark::kMillisecond);
+
+static void het_container_generate_sum(benchmark::State& state) {
+  auto values = scan_fractions();
+  std::array<std::byte, 1024> buffer{};
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    double sum = 0;
+    for(auto e : values.generate<int, float>(&arena)) {
+      sum += std::visit([](auto v) { return static_cast<double>(v.get()); }, e);
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_generate_sum)->Unit(benchmark::kMillisecond);
+
+static void het_container_generate_batches_sum(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    double sum = 0;
+    for(auto batch : values.generate_batches<int, float>(static_cast<std::size_t>(state.range(0)))) {
+      for(auto e : batch) {
+        sum += std::visit([](auto v) { return static_cast<double>(v.get()); }, e);
+      }
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_generate_batches_sum)->Arg(64)->Arg(4096)->Unit(benchmark::kMillisecond);
+
 static void het_container_visit_access(benchmark::State& state) {
   het::hvector hc;
   auto visitor = hc.visit<int, float, double, char, std::string_view, std::string>();
@@ -146,6 +490,100 @@ static void het_container_match_access(benchmark::State& state) {
 // Register the function as a benchmark
 BENCHMARK(het_container_match_access);
 
+static void het_container_visit_sequential(benchmark::State& state) {
+  auto values = scan_fractions();
+  auto visitor = values.visit<int, float>();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::atomic<long> sum{0};
+    visitor([&sum](auto v) {
+      sum.fetch_add(static_cast<long>(std::sqrt(static_cast<double>(v))) & 1, std::memory_order_relaxed);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_visit_sequential)->Unit(benchmark::kMillisecond);
+
+static void het_container_visit_parallel(benchmark::State& state) {
+  auto values = scan_fractions();
+  auto visitor = values.visit_par<int, float>();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::atomic<long> sum{0};
+    visitor([&sum](auto v) {
+      sum.fetch_add(static_cast<long>(std::sqrt(static_cast<double>(v))) & 1, std::memory_order_relaxed);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_visit_parallel)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// the argument is the number of the threads, the workers of the scheduler and the calling thread
+static void het_container_visit_scaling(benchmark::State& state) {
+  auto values = scan_fractions();
+  het::task_scheduler scheduler(static_cast<std::size_t>(state.range(0)) - 1);
+  auto visitor = values.visit_par<int, float>({&scheduler});
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    std::atomic<long> sum{0};
+    visitor([&sum](auto v) {
+      sum.fetch_add(static_cast<long>(std::sqrt(static_cast<double>(v))) & 1, std::memory_order_relaxed);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_visit_scaling)->DenseRange(1, std::max(static_cast<int>(std::thread::hardware_concurrency()), 1))
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void het_container_find_all_parallel(benchmark::State& state) {
+  auto values = scan_fractions();
+  std::vector<int> out;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    out.clear();
+    het::find_all<int>(values, het::parallel_policy{}, std::back_inserter(out), [](int v) { return v % 100 == 0; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(out);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_find_all_parallel)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void het_container_find_all_sequential(benchmark::State& state) {
+  auto values = scan_fractions();
+  std::vector<int> out;
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    out.clear();
+    het::find_all<int>(values, std::back_inserter(out), [](int v) { return v % 100 == 0; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(out);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_find_all_sequential)->Unit(benchmark::kMillisecond);
+
+static void het_container_count_if_parallel(benchmark::State& state) {
+  auto values = scan_fractions();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto count = het::count_if<int>(values, het::parallel_policy{}, [](int v) { return v % 100 == 0; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(count);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_count_if_parallel)->Unit(benchmark::kMillisecond)->UseRealTime();
+
 static void tuple_container_access(benchmark::State& state) {
   std::vector<std::tuple<int, float, double, char, std::string_view, std::string>> values;
   std::size_t k = 0;
@@ -175,3 +613,418 @@ static void tuple_container_access(benchmark::State& state) {
 }
 // Register the function as a benchmark
 BENCHMARK(tuple_container_access);
+
+static void static_container_access(benchmark::State& state) {
+  het::svector<int, float, double, char, std::string_view, std::string> values;
+  // Code inside this loop is measured repeatedly
+  std::size_t k = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    values.push_back(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    k++;
+    auto & fi = values.fraction<int>();
+    auto & ff = values.fraction<float>();
+    auto & fd = values.fraction<double>();
+    auto & fc = values.fraction<char>();
+    auto & fsv = values.fraction<std::string_view>();
+    auto & fs = values.fraction<std::string>();
+    state.ResumeTiming();
+    for(std::size_t l = 0; l < k; ++l) {
+      auto i = fi.at(l);
+      auto f = ff.at(l);
+      auto d = fd.at(l);
+      auto c = fc.at(l);
+      auto sv = fsv.at(l);
+      auto s = fs.at(l);
+      // Make sure the variable is not optimized away by compiler
+      benchmark::DoNotOptimize(i);
+      benchmark::DoNotOptimize(f);
+      benchmark::DoNotOptimize(d);
+      benchmark::DoNotOptimize(c);
+      benchmark::DoNotOptimize(sv);
+      benchmark::DoNotOptimize(s);
+    }
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(static_container_access);
+
+static void static_container_visit_access(benchmark::State& state) {
+  het::svector<int, float, double, char, std::string_view, std::string> hc;
+  auto visitor = hc.visit<int, float, double, char, std::string_view, std::string>();
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    state.PauseTiming();
+    hc.push_back(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    state.ResumeTiming();
+    visitor([](auto) {return het::VisitorReturn::Continue;});
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(hc);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(static_container_visit_access);
+
+static void het_container_move(benchmark::State& state) {
+  het::hvector values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(int{i}, 1.2f, 3., 'c', "stringview"sv, "string"s);
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector moved(std::move(values));
+    values = std::move(moved);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_move);
+
+static void het_registry_container_move(benchmark::State& state) {
+  het::hash_key_container<std::vector> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(int{i}, 1.2f, 3., 'c', "stringview"sv, "string"s);
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hash_key_container<std::vector> moved(std::move(values));
+    values = std::move(moved);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_registry_container_move);
+
+static void het_container_lifecycle(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector values(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    het::hvector copy(values);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_lifecycle);
+
+static void het_container_copy(benchmark::State& state) {
+  het::hvector values(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector copy(values);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_copy);
+
+static void het_container_size(benchmark::State& state) {
+  het::hvector values(1, 1.2f, 3., 'c', "stringview"sv, "string"s);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto size = values.size();
+    auto empty = values.empty();
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(size);
+    benchmark::DoNotOptimize(empty);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_size);
+
+// every thread churns its own containers, the shared state is only the storage registry
+template <typename HC> static void het_container_churn(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    HC values(int{1}, 1.2f, 3., 'c', "stringview"sv, "string"s);
+    values.push_back(int{2}, 2.2f);
+    HC copy(values);
+    values.template erase<double>(0);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+// Register the function as a benchmark
+BENCHMARK_TEMPLATE(het_container_churn, het::hvector)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(het_container_churn, het::concurrent_key_container<std::vector>)->ThreadRange(1, 16)->UseRealTime();
+
+static void het_container_ordered_visit(benchmark::State& state) {
+  het::hvector hc;
+  hc.keep_insertion_order();
+  for(int i = 0; i < 1000; ++i) {
+    hc.push_back(int{i}, 1.2f, 3., 'c');
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    double sum = 0;
+    hc.ordered_visit<int, float, double, char>()([&sum](auto v) {
+      sum += static_cast<double>(v);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * 4000);
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_ordered_visit);
+
+// the parallel variant vector which keeps the arrival order besides the containers
+static void variant_vector_ordered_visit(benchmark::State& state) {
+  std::vector<std::variant<int, float, double, char>> vs;
+  for(int i = 0; i < 1000; ++i) {
+    vs.insert(vs.end(), {i, 1.2f, 3., 'c'});
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    double sum = 0;
+    for(auto & v : vs) {
+      std::visit([&sum](auto x) { sum += static_cast<double>(x); }, v);
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * 4000);
+}
+// Register the function as a benchmark
+BENCHMARK(variant_vector_ordered_visit);
+
+static void packed_container_push_back(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::spacked<int, float, double, char> values;
+    for(int i = 0; i < 1000; ++i) {
+      values.push_back(i, 1.2f, 3., 'c');
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+  state.SetItemsProcessed(state.iterations() * 4000);
+}
+// Register the function as a benchmark
+BENCHMARK(packed_container_push_back);
+
+static void het_container_pod_push_back(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector values;
+    for(int i = 0; i < 1000; ++i) {
+      values.push_back(int{i}, 1.2f, 3., 'c');
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+  state.SetItemsProcessed(state.iterations() * 4000);
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_pod_push_back);
+
+static void packed_container_copy(benchmark::State& state) {
+  het::spacked<int, float, double, char> values;
+  for(int i = 0; i < 1000; ++i) {
+    values.push_back(i, 1.2f, 3., 'c');
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto copy = values;
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(packed_container_copy);
+
+static void het_container_pod_copy(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1000; ++i) {
+    values.push_back(int{i}, 1.2f, 3., 'c');
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto copy = values;
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_pod_copy);
+
+static void packed_container_visit(benchmark::State& state) {
+  het::spacked<int, float, double, char> values;
+  for(int i = 0; i < 1000; ++i) {
+    values.push_back(i, 1.2f, 3., 'c');
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    double sum = 0;
+    values.visit<int, float, double, char>()([&sum](auto v) {
+      sum += static_cast<double>(v);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * 4000);
+}
+// Register the function as a benchmark
+BENCHMARK(packed_container_visit);
+
+static void het_container_pod_visit(benchmark::State& state) {
+  het::hvector values;
+  for(int i = 0; i < 1000; ++i) {
+    values.push_back(int{i}, 1.2f, 3., 'c');
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    double sum = 0;
+    values.visit<int, float, double, char>()([&sum](auto v) {
+      sum += static_cast<double>(v);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * 4000);
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_pod_visit);
+
+// few elements of many types, the typical shape of a per-request container
+template <typename HC> static void het_container_few_of_many(benchmark::State& state) {
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    HC values;
+    values.push_back(int{1}, 1.2f, 3., 'c', "stringview"sv, std::size_t{1}, short{1}, true);
+    values.push_back(int{2}, 2.2f, 4., 'd', "stringview"sv, std::size_t{2}, short{2}, false);
+    double sum = 0;
+    values.template visit<int, float, double, std::size_t, short>()([&sum](auto v) {
+      sum += static_cast<double>(v);
+      return het::VisitorReturn::Continue;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK_TEMPLATE(het_container_few_of_many, het::hvector);
+BENCHMARK_TEMPLATE(het_container_few_of_many, het::hsmall_vector<4>);
+BENCHMARK_TEMPLATE(het_container_few_of_many, het::hash_key_container<std::vector>);
+BENCHMARK_TEMPLATE(het_container_few_of_many, het::hash_key_container<het::small_vector_n<4>::type>);
+
+template <typename HC> static void het_container_few_of_many_copy(benchmark::State& state) {
+  HC values;
+  values.push_back(int{1}, 1.2f, 3., 'c', "stringview"sv, std::size_t{1}, short{1}, true);
+  values.push_back(int{2}, 2.2f, 4., 'd', "stringview"sv, std::size_t{2}, short{2}, false);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    HC copy(values);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(copy);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK_TEMPLATE(het_container_few_of_many_copy, het::hvector);
+BENCHMARK_TEMPLATE(het_container_few_of_many_copy, het::hsmall_vector<4>);
+
+// loading of 1M elements of mixed types, element by element vs. the bulk path
+static constexpr std::size_t bulk_load_size = 1'000'000 / 3;
+
+static void het_container_load_push_back(benchmark::State& state) {
+  std::vector<int> ints(bulk_load_size, 1);
+  std::vector<double> doubles(bulk_load_size, 2.);
+  std::vector<std::string_view> views(bulk_load_size, "stringview"sv);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector values;
+    for(std::size_t i = 0; i < bulk_load_size; ++i) {
+      values.push_back(ints[i], doubles[i], views[i]);
+    }
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_load_push_back)->Unit(benchmark::kMillisecond);
+
+static void het_container_load_append_range(benchmark::State& state) {
+  std::vector<int> ints(bulk_load_size, 1);
+  std::vector<double> doubles(bulk_load_size, 2.);
+  std::vector<std::string_view> views(bulk_load_size, "stringview"sv);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    het::hvector values;
+    values.reserve<int, double, std::string_view>(ints.size(), doubles.size(), views.size());
+    values.append_range<int>(ints);
+    values.append_range<double>(doubles);
+    values.append_range<std::string_view>(views);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(values);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_load_append_range)->Unit(benchmark::kMillisecond);
+
+struct bench_fill {
+  int order_id;
+  double quantity;
+};
+
+static het::hvector join_fractions(int orders) {
+  het::hvector values;
+  for(int i = 0; i < orders; ++i) {
+    values.emplace_back<bench_record>(i, 1.);
+    for(int k = 0; k < 3; ++k) {
+      values.emplace_back<bench_fill>((i * 7919 + k) % orders, 1.);
+    }
+  }
+  return values;
+}
+
+static void het_container_find_first_nested(benchmark::State& state) {
+  auto values = join_fractions(2'000);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::find_first<bench_record, bench_fill>(values, [](bench_record const & r, bench_fill const & f) {
+      return r.id == f.order_id && r.id == 1'999;
+    });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_find_first_nested)->Unit(benchmark::kMillisecond);
+
+static void het_container_find_first_hash_join(benchmark::State& state) {
+  auto values = join_fractions(2'000);
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto found = het::find_first<bench_record, bench_fill>(values, &bench_record::id, &bench_fill::order_id,
+                                                           [](bench_record const & r, bench_fill const &) { return r.id == 1'999; });
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(found);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_find_first_hash_join)->Unit(benchmark::kMillisecond);
+
+static void het_container_join(benchmark::State& state) {
+  auto values = join_fractions(static_cast<int>(state.range(0)));
+  if(state.range(1) != 0) {
+    values.create_index<bench_fill>(&bench_fill::order_id);
+  }
+  // Code inside this loop is measured repeatedly
+  for (auto _ : state) {
+    auto pairs = het::join<bench_record, bench_fill>(values, &bench_record::id, &bench_fill::order_id);
+    // Make sure the variable is not optimized away by compiler
+    benchmark::DoNotOptimize(pairs);
+  }
+}
+// Register the function as a benchmark
+BENCHMARK(het_container_join)->Args({100'000, 0})->Args({100'000, 1})->Unit(benchmark::kMillisecond);
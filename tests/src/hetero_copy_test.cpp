@@ -70,9 +70,9 @@ TEST_CASE("heterogeneous container copy test") {
   std::cout << h.size() << "\n";
   //std::cout << h.at<int>(0) << "\n";
 
-  std::cout << w.size() << "\n";
-  std::cout << w.at<double>(0) << "\n";
-  std::cout << w.at<int>(0) << "\n";
+  // the moved-from container is left empty
+  CHECK(w.empty());
+  CHECK(!w.contains<double>());
 
   std::cout << w0.size() << "\n";
   std::cout << w0.at<float>(0) << "\n";
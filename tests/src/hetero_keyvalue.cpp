@@ -6,6 +6,9 @@
 #include <sstream>
 #include <cstring>
 #include <memory>
+#include <memory_resource>
+#include <thread>
+#include <atomic>
 
 #include "het/het_keyvalue.h"
 
@@ -21,6 +24,133 @@ TEST_CASE("heterogeneous key-value add-or-default ctor test") {
   CHECK(hkv1.value_or_add(2, "string2"s) == "string2"s);
 }
 
+TEST_CASE("heterogeneous key-value move and swap test") {
+  het::hkeyvalue hkv(std::make_pair(1, "string"s), std::make_pair(2, "string2"s), std::make_pair('c', 1));
+  auto const * ps = &hkv.value<std::string>(1);
+  het::hkeyvalue hkv1(std::move(hkv));
+  CHECK(hkv.empty());
+  CHECK_EQ(hkv1.size(), 3);
+  CHECK(&hkv1.value<std::string>(1) == ps);
+
+  het::hkeyvalue hkv2(std::make_pair(1, 1.));
+  swap(hkv1, hkv2);
+  CHECK_EQ(hkv1.size(), 1);
+  CHECK_EQ(hkv2.size(), 3);
+  CHECK(&hkv2.value<std::string>(1) == ps);
+  CHECK_EQ(hkv2.value<int>('c'), 1);
+
+  hkv1 = hkv2;
+  CHECK_EQ(hkv1.size(), 3);
+  CHECK(&hkv1.value<std::string>(1) != ps);
+}
+
+TEST_CASE("memory resource based key-value test") {
+  std::pmr::monotonic_buffer_resource arena;
+  het::pmr_hkeyvalue hkv(std::allocator_arg, &arena, std::make_pair(1, std::pmr::string{"string"}), std::make_pair('c', 1));
+  CHECK(hkv.resource() == &arena);
+  CHECK(hkv.value<std::pmr::string>(1).get_allocator().resource() == &arena);
+
+  het::pmr_hkeyvalue hkv1(std::move(hkv));
+  CHECK(hkv.empty());
+  CHECK(hkv1.value<std::pmr::string>(1).get_allocator().resource() == &arena);
+
+  het::pmr_hkeyvalue hkv2;
+  hkv2 = std::move(hkv1);
+  CHECK(hkv1.empty());
+  CHECK_EQ(hkv2.size(), 2);
+  CHECK(hkv2.value<std::pmr::string>(1) == "string");
+  CHECK(hkv2.value<std::pmr::string>(1).get_allocator().resource() == std::pmr::get_default_resource());
+}
+
+TEST_CASE("concurrent key-value test") {
+  constexpr int threads_count = 8;
+  std::vector<std::size_t> sizes(threads_count);
+  std::vector<std::thread> threads;
+  for(int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([t, &sizes] {
+      for(int r = 0; r < 200; ++r) {
+        het::concurrent_hkeyvalue hkv(std::make_pair(t, "string"s), std::make_pair('c', r));
+        het::concurrent_hkeyvalue hkv1(std::move(hkv));
+        hkv1.add_values(std::make_pair(r, 1.));
+        sizes[t] += hkv1.size() + (hkv1.value<int>('c') == r ? 1 : 0);
+      }
+    });
+  }
+  for(auto & thread : threads) {
+    thread.join();
+  }
+  for(auto sz : sizes) {
+    CHECK(sz == 800);
+  }
+}
+
+TEST_CASE("heterogeneous key-value memory usage test") {
+  het::hkeyvalue hkv(std::make_pair(1, 1.), std::make_pair(2, 2.), std::make_pair('c', 1));
+  auto report = hkv.memory_usage();
+  REQUIRE(report.types.size() == 2);
+  CHECK(report.types[0].key == typeid(int));
+  CHECK(report.types[0].type == typeid(double));
+  CHECK(report.types[0].count == 2);
+  CHECK(report.types[0].usage.element_bytes == 2 * sizeof(std::pair<int const, double>));
+  CHECK(report.types[1].key == typeid(char));
+  CHECK(report.total.element_bytes == 2 * sizeof(std::pair<int const, double>) + sizeof(std::pair<char const, int>));
+  CHECK(report.total.bookkeeping_bytes > 0);
+
+  auto stats = het::hkeyvalue::registry_stats<int, double>();
+  CHECK(stats.size >= 1);
+  CHECK(stats.bucket_count >= stats.size);
+  CHECK(stats.load_factor > 0.f);
+  CHECK(het::concurrent_hkeyvalue::registry_stats<int, double>().size == 0);
+}
+
+TEST_CASE("heterogeneous key-value cached size test") {
+  het::hkeyvalue hkv(std::make_pair(1, 1.), std::make_pair(2, 2.), std::make_pair('c', 1));
+  CHECK(hkv.size() == 3);
+  hkv.modify_values(std::make_pair(1, 3.));
+  CHECK(hkv.size() == 3);
+  CHECK(hkv.erase_value<double>(1));
+  CHECK(!hkv.erase_value<double>(1));
+  CHECK(hkv.size() == 2);
+  het::hkeyvalue hkv1(hkv);
+  het::hkeyvalue hkv2(std::move(hkv));
+  CHECK(hkv.empty());
+  CHECK(hkv1.size() == 2);
+  CHECK(hkv2.size() == 2);
+  hkv2.clear();
+  CHECK(hkv2.empty());
+}
+
+TEST_CASE("heterogeneous key-value parallel visit and match test") {
+  het::hkeyvalue hkv;
+  for(int i = 0; i < 1000; ++i) {
+    hkv.add_values(std::make_pair(i, i * 2), std::make_pair(i, "v"s));
+  }
+  het::task_scheduler scheduler(3);
+  het::parallel_policy policy{&scheduler, 50};
+
+  std::atomic<long> sum{0};
+  CHECK(hkv.visit_par<int, int>(policy)([&sum](int k, int v) {
+    sum += k + v;
+    return het::VisitorReturn::Continue;
+  }) == het::VisitorReturn::Continue);
+  CHECK(sum == 3 * 499'500);
+  std::atomic<int> visited{0};
+  CHECK(hkv.visit_par<int, int, std::string>(het::parallel_policy{&scheduler, 10})([&visited](int, auto const &) {
+    ++visited;
+    return het::VisitorReturn::Break;
+  }) == het::VisitorReturn::Break);
+  CHECK(visited < 2000);
+
+  std::atomic<std::size_t> chars{0};
+  std::atomic<int> ints{0};
+  CHECK(hkv.match_par<int, std::string, int>(policy)(
+      [&chars](int, std::string const & s) { chars += s.size(); },
+      [&ints](int, int) { ++ints; }));
+  CHECK(chars == 1000);
+  CHECK(ints == 1000);
+  CHECK(!hkv.match_par<int, double>(policy)([](int, double) {}));
+}
+
 TEST_CASE("heterogeneous key-value one-by-one ctor test") {
   het::hkeyvalue hkv;
 
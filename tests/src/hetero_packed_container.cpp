@@ -0,0 +1,159 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#include <doctest.h>
+
+#include "het/het_packed_container.h"
+
+#include <array>
+#include <sstream>
+#include <memory_resource>
+
+struct packed_rec {
+  int id;
+  double value;
+};
+
+TEST_CASE("packed heterogeneous container test") {
+  het::spacked<int, double, char, packed_rec> hc;
+  CHECK(hc.empty());
+  CHECK(!hc.contains<int>());
+  CHECK(!hc.contains<float>());
+
+  hc.push_back('a', 1, 2.0, 3);
+  hc.emplace_back<packed_rec>(7, 0.5);
+  hc.push_front(0);
+  CHECK(hc.size() == 6);
+  CHECK(hc.count_of<int>() == 3);
+  CHECK(hc.count_of<float>() == 0);
+  CHECK(hc.at<int>(0) == 0);
+  CHECK(hc.at<int>(2) == 3);
+  CHECK(hc.fraction<packed_rec>()[0].id == 7);
+  CHECK_THROWS_AS(hc.at<char>(1), std::out_of_range);
+
+  for(int i = 0; i < 100; ++i) {
+    hc.push_back(i);
+  }
+  CHECK(hc.count_of<int>() == 103);
+  CHECK(hc.at<double>(0) == 2.0);
+  CHECK(hc.at<char>(0) == 'a');
+
+  CHECK(hc.erase(3));
+  CHECK(!hc.erase(-1));
+  hc.erase<int>(0);
+  hc.pop_back<int>();
+  hc.pop_front<double>();
+  CHECK(hc.count_of<int>() == 100);
+  CHECK(hc.at<int>(0) == 1);
+  CHECK(hc.at<int>(99) == 98);
+  CHECK(!hc.contains<double>());
+  CHECK_THROWS_AS(hc.pop_back<double>(), std::out_of_range);
+  CHECK_THROWS_AS(hc.pop_front<double>(), std::out_of_range);
+  CHECK_THROWS_AS(hc.erase<int>(std::size_t{100}), std::out_of_range);
+  CHECK(hc.count_of<int>() == 100);
+  CHECK(hc.count_of<double>() == 0);
+
+  auto hc1 = hc;
+  CHECK(hc1.size() == hc.size());
+  CHECK(hc1.fraction<int>().data() != hc.fraction<int>().data());
+  CHECK(std::equal(hc1.fraction<int>().begin(), hc1.fraction<int>().end(), hc.fraction<int>().begin()));
+
+  auto const * pi = hc.fraction<int>().data();
+  auto hc2 = std::move(hc);
+  CHECK(hc.empty());
+  CHECK(hc2.fraction<int>().data() == pi);
+
+  hc2.shrink_to_fit();
+  CHECK(hc2.capacity<int>() == 100);
+  hc2.clear();
+  CHECK(hc2.empty());
+  CHECK(hc2.capacity<int>() == 0);
+
+  auto [i, c] = hc1.to_tuple<int, char>();
+  CHECK(i == 1);
+  CHECK(c == 'a');
+  CHECK(!hc1.try_to_tuple<double>().has_value());
+}
+
+TEST_CASE("packed heterogeneous container pop_front test") {
+  // pop_front erases the first element, not the first one equal to zero
+  het::spacked<int, double> hc;
+  CHECK_THROWS_AS(hc.pop_front<int>(), std::out_of_range);
+  hc.push_back(5, 0, 7);
+  hc.pop_front<int>();
+  CHECK(hc.count_of<int>() == 2);
+  CHECK(hc.at<int>(0) == 0);
+  CHECK(hc.at<int>(1) == 7);
+  CHECK(hc.erase(7));
+  hc.pop_front<int>();
+  CHECK(hc.empty());
+  CHECK_THROWS_AS(hc.pop_front<int>(), std::out_of_range);
+}
+
+TEST_CASE("packed heterogeneous container layout and visit test") {
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+  het::spacked<char, double, int> hc(&arena);
+  hc.reserve<char, double, int>(4);
+  auto const * pc = hc.fraction<char>().data();
+  hc.push_back('a', 1.5, 2, 'b', 3);
+  CHECK(hc.fraction<char>().data() == pc);
+  CHECK(reinterpret_cast<std::uintptr_t>(hc.fraction<double>().data()) % alignof(double) == 0);
+  CHECK(static_cast<void const *>(hc.fraction<char>().data()) < static_cast<void const *>(hc.fraction<double>().data()));
+  CHECK(static_cast<void const *>(hc.fraction<double>().data()) < static_cast<void const *>(hc.fraction<int>().data()));
+
+  std::stringstream ss;
+  hc.visit<char, double, int>()([&ss](auto v) {
+    ss << v;
+    return het::VisitorReturn::Continue;
+  });
+  CHECK(ss.str() == "ab1.523");
+
+  std::stringstream ss1;
+  hc.match<int, char>()([&ss1](auto v) { ss1 << v << ','; });
+  CHECK(ss1.str() == "2,3,a,b,");
+
+  // match fails on a type without elements as the other containers do
+  het::spacked<char, double, int> chars('x');
+  CHECK(!chars.match<char, int>()([](auto) {}));
+  CHECK(chars.match<char>()([](auto) {}));
+
+  CHECK(hc.contains<int>(std::pair{[](int v) { return v * 2; }, 6}));
+  CHECK(hc.find<int>(std::pair{[](int v) { return v; }, 3}).first);
+  CHECK(!hc.find<int>(std::pair{[](int v) { return v; }, 4}).first);
+}
+
+TEST_CASE("packed heterogeneous container failed copy test") {
+  // the copy of the buffer is allocated before the old one is released, its failure leaves the container intact
+  struct failing_resource : std::pmr::memory_resource {
+    bool fail = false;
+    void * do_allocate(std::size_t bytes, std::size_t align) override {
+      if(fail) {
+        throw std::bad_alloc();
+      }
+      return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void * p, std::size_t bytes, std::size_t align) override {
+      std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    [[nodiscard]] bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override {
+      return this == &other;
+    }
+  } failing;
+  het::spacked<int, double> to(&failing);
+  to.push_back(1, 2.);
+  het::spacked<int, double> from(3, 4, 5.);
+  failing.fail = true;
+  CHECK_THROWS_AS(to = from, std::bad_alloc);
+  CHECK_THROWS_AS(to = std::move(from), std::bad_alloc);
+  CHECK(to.size() == 2);
+  CHECK(to.at<int>(0) == 1);
+  CHECK(to.at<double>(0) == 2.);
+  CHECK(from.size() == 3);
+  failing.fail = false;
+  to = std::move(from);
+  CHECK(to.count_of<int>() == 2);
+  CHECK(to.at<int>(1) == 4);
+  CHECK(from.empty());
+}
@@ -0,0 +1,89 @@
+//
+// Created by yuri on 10/16/26.
+//
+
+#include <doctest.h>
+
+#include "het/het_static_container.h"
+
+#include <string>
+#include <sstream>
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+TEST_CASE("static heterogeneous vector based container test") {
+  het::svector<int, double, char, std::string> hc;
+  CHECK(hc.empty());
+  CHECK(!hc.contains<int>());
+  CHECK(!hc.contains<float>());
+
+  hc.push_back('a', 1, 2.0, 3, "foo"s);
+
+  CHECK(!hc.empty());
+  CHECK(hc.size() == 5);
+  CHECK(hc.count_of<int>() == 2);
+  CHECK(hc.count_of<float>() == 0);
+  CHECK(hc.at<int>(1) == 3);
+  CHECK(hc.fraction<std::string>()[0] == "foo");
+
+  hc.erase<double>(0);
+  CHECK(hc.count_of<double>() == 0);
+  CHECK(hc.size() == 4);
+  CHECK(hc.erase(3));
+  CHECK(!hc.erase(3));
+
+  auto hc1 = hc;
+  hc.clear();
+  CHECK(hc.empty());
+  CHECK(hc1.size() == 3);
+
+  auto [i, c, s] = het::to_tuple<int, char, std::string>(hc1);
+  CHECK(i == 1);
+  CHECK(c == 'a');
+  CHECK(s == "foo");
+  CHECK(!het::try_to_tuple<double>(hc1).has_value());
+}
+
+TEST_CASE("static heterogeneous container find/query test") {
+  using rec = std::pair<std::string_view, std::string_view>;
+  het::svector<int, rec> hc{1, 3, 3, 0, rec{"R0"sv, "apple"sv}, rec{"R1"sv, "orange"sv}, rec{"R0"sv, "orange"sv}};
+
+  auto retval1 = het::find_first<int>(hc, [](auto const & value) { return value == 3; });
+  auto retval2 = het::find_last<int>(hc, [](auto const & value) { return value == 3; });
+  CHECK(retval1.first);
+  CHECK(retval2.first);
+  CHECK((retval1.second + 1 == retval2.second));
+  CHECK(het::find_last<int>(hc, [](auto const & value) { return value == 1; }).first);
+  CHECK(!het::find_first<int>(hc, [](auto const & value) { return value == 5; }).first);
+
+  std::vector<int> o;
+  CHECK(het::find_all<int>(hc, std::back_inserter(o), [](auto const & value) { return value > 0; }));
+  CHECK(o == std::vector<int>{1, 3, 3});
+
+  auto q = het::query_first<rec>(hc, std::pair{&rec::first, "R0"sv}, std::pair{&rec::second, "orange"sv});
+  CHECK(q.first);
+  CHECK((*q.second == rec{"R0"sv, "orange"sv}));
+  CHECK(het::query_last<rec>(hc, std::pair{&rec::second, "orange"sv}).second == q.second);
+  CHECK(hc.contains<rec>(std::pair{&rec::first, "R1"sv}));
+  CHECK(hc.find<rec>(std::pair{&rec::second, "apple"sv}).first);
+  CHECK(het::query_first<rec>(hc, het::where(het::field(&rec::first) == "R0"sv && het::field(&rec::second) != "apple"sv)).second == q.second);
+  CHECK(het::query_last<rec>(hc, het::where(het::field(&rec::first) > "R0"sv)).second->second == "orange");
+}
+
+TEST_CASE("static heterogeneous container visit/match test") {
+  het::svector<std::string_view, double, std::string, int *> hc{""sv, ""s, 1.};
+  std::stringstream ss;
+  hc.match<std::string_view, double, std::string>()(
+      [&ss](std::string_view) { ss << 2; },
+      [&ss](auto) { ss << "default"; });
+  CHECK(ss.str() == "2default2");
+  CHECK(!hc.match<int *>()([](auto) {}));
+
+  int visited = 0;
+  CHECK(hc.visit<double, std::string_view>()([&visited](auto const &) {
+    visited++;
+    return het::VisitorReturn::Break;
+  }) == het::VisitorReturn::Break);
+  CHECK(visited == 1);
+}
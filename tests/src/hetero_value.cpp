@@ -7,6 +7,8 @@
 
 #include "het/het_value.h"
 
+#include <memory_resource>
+
 #include "include/hetero_test.h"
 
 using namespace std::string_literals;
@@ -68,6 +70,69 @@ TEST_CASE("heterogeneous value move ctor test") {
   CHECK(*hv.template value<std::unique_ptr<int>>().get() == *std::make_unique<int>(123).get());
 }
 
+TEST_CASE("heterogeneous value move and swap test") {
+  het::hvalue hv(1, "foo"s);
+  auto const * ps = &hv.value<std::string>();
+  het::hvalue hv1(std::move(hv));
+  CHECK(hv.empty());
+  CHECK(!hv.contains<int>());
+  CHECK_EQ(hv1.arity(), 2);
+  CHECK(&hv1.value<std::string>() == ps);
+
+  het::hvalue hv2('c');
+  hv2.swap(hv1);
+  CHECK_EQ(hv1.arity(), 1);
+  CHECK_EQ(hv1.value<char>(), 'c');
+  CHECK(&hv2.value<std::string>() == ps);
+  CHECK_EQ(hv2.value<int>(), 1);
+
+  hv1 = std::move(hv2);
+  CHECK(hv2.empty());
+  CHECK(!hv1.contains<char>());
+  CHECK(&hv1.value<std::string>() == ps);
+}
+
+TEST_CASE("memory resource based value test") {
+  std::pmr::monotonic_buffer_resource arena;
+  het::hvalue hv(std::allocator_arg, &arena, std::pmr::string{"string"}, 1);
+  CHECK(hv.resource() == &arena);
+  CHECK(hv.value<std::pmr::string>().get_allocator().resource() == &arena);
+
+  het::hvalue hv1(std::move(hv));
+  CHECK(hv1.value<std::pmr::string>().get_allocator().resource() == &arena);
+
+  het::hvalue hv2(hv1);
+  CHECK(hv2.value<std::pmr::string>() == "string");
+  CHECK(hv2.value<std::pmr::string>().get_allocator().resource() == std::pmr::get_default_resource());
+
+  hv2 = std::move(hv1);
+  CHECK(hv1.empty());
+  CHECK(hv2.value<int>() == 1);
+  CHECK(hv2.value<std::pmr::string>().get_allocator().resource() == std::pmr::get_default_resource());
+}
+
+TEST_CASE("heterogeneous value memory usage test") {
+  het::hvalue hv(1, 2.);
+  auto report = hv.memory_usage();
+  REQUIRE(report.types.size() == 2);
+  CHECK(report.types[0].type == typeid(int));
+  CHECK(report.types[0].count == 1);
+  CHECK(report.types[1].usage.element_bytes == sizeof(double));
+  CHECK(report.total.element_bytes == sizeof(int) + sizeof(double));
+  CHECK(report.total.slack_bytes == 0);
+  CHECK(report.total.bookkeeping_bytes > 2 * sizeof(void *));
+
+  hv.erase_values<double>();
+  CHECK(hv.memory_usage().total.element_bytes == sizeof(int));
+
+  auto stats = het::hvalue::registry_stats<int>();
+  CHECK(stats.size >= 1);
+  CHECK(stats.bucket_count >= stats.size);
+  CHECK(stats.load_factor > 0.f);
+  CHECK(stats.bytes > 0);
+  CHECK(het::concurrent_hvalue::registry_stats<int>().size == 0);
+}
+
 TEST_CASE("heterogeneous value bulk ctor test") {
   het::hvalue hv;
   hv.add_values(1, 2l, std::string_view("string"), 3.f, 'c', 4.);